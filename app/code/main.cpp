@@ -40,25 +40,35 @@ namespace
 
     void load_ground (Scene & scene, std::mutex& mtx)
     {
-        std::lock_guard<std::mutex> lock(mtx); //Protege el acceso concurrente a la escena
-        auto & entity = scene.create_entity ();
+        Path_Tracing::Model * model_component;
 
-        scene.create_component< Transform > (entity);
+        {
+            std::lock_guard<std::mutex> lock(mtx); //Protege el acceso concurrente a la escena
+
+            auto & entity = scene.create_entity ();
 
-        auto model_component = scene.create_component< Path_Tracing::Model > (entity);
+            scene.create_component< Transform > (entity);
 
+            model_component = scene.create_component< Path_Tracing::Model > (entity);
+        }
+
+        //Los materiales y las primitivas se crean en arenas propias de cada hilo, sin bloquear
         model_component->add_plane (Vector3{0, .25f, 0}, Vector3{0, -1, 0}, model_component->add_diffuse_material (Path_Tracing::Color(.4f, .4f, .5f)));
     }
 
     void load_shape (Scene & scene, std::mutex& mtx)
     {
-        std::lock_guard<std::mutex> lock(mtx); //Evita condiciones de carrera
+        Path_Tracing::Model * model_component;
 
-        auto & entity = scene.create_entity ();
+        {
+            std::lock_guard<std::mutex> lock(mtx); //Evita condiciones de carrera
 
-        scene.create_component< Transform > (entity);
+            auto & entity = scene.create_entity ();
+
+            scene.create_component< Transform > (entity);
 
-        auto model_component = scene.create_component< Path_Tracing::Model > (entity);
+            model_component = scene.create_component< Path_Tracing::Model > (entity);
+        }
 
         model_component->add_sphere (Vector3{.0f, 0.f, -1.0f}, .25f, model_component->add_diffuse_material  (Path_Tracing::Color(.8f, .8f, .8f)));
         model_component->add_sphere (Vector3{.5f, 0.f, -1.1f}, .15f, model_component->add_metallic_material (Path_Tracing::Color(.4f, .5f, .6f), 0.1f));
@@ -7,17 +7,24 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <string>
 #include <thread>
-#include <atomic>
-#include <mutex>
+#include <vector>
 
 #include <engine/Entity.hpp>
 #include <engine/Stage.hpp>
 #include <engine/Subsystem.hpp>
 #include <engine/Transform.hpp>
+#include <engine/Triple_Buffer.hpp>
 
+#include <raytracer/Buffer.hpp>
 #include <raytracer/Camera.hpp>
+#include <raytracer/Cancellation_Token.hpp>
+#include <raytracer/Color.hpp>
 #include <raytracer/Diffuse_Material.hpp>
 #include <raytracer/Linear_Space.hpp>
 #include <raytracer/Material.hpp>
@@ -26,6 +33,7 @@
 #include <raytracer/Path_Tracer.hpp>
 #include <raytracer/Scene.hpp>
 #include <raytracer/Sky_Environment.hpp>
+#include <raytracer/Texture.hpp>
 
 namespace udit::engine
 {
@@ -36,37 +44,68 @@ namespace udit::engine
 
         class Stage : public engine::Stage
         {
-            Path_Tracing * subsystem;
+            using Frame = raytracer::Buffer< raytracer::Color >;
+
+            Path_Tracing          * subsystem;
+
+            // El trazado publica cada instantánea terminada y el hilo de presentación
+            // muestra siempre la última, sin que ninguno de los dos espere al otro.
+
+            Triple_Buffer< Frame >  frames;
+            std::thread             presentation_thread;
+            std::atomic< bool >     running;
+
+            // El fotograma se traza fuera del hilo principal, que mientras tanto sigue leyendo la
+            // entrada y moviendo la cámara. Se guardan las transformaciones de las cámaras con las
+            // que empezó para saber si lo que se está trazando ya no es lo que se va a ver.
+
+            std::future< void >      tracing;
+            std::vector< Transform > traced_cameras;
+            bool                     camera_moving;
+
+            static constexpr std::chrono::milliseconds polling_interval{ 16 };     // Lo que se espera al fotograma en cada vuelta del bucle
 
         public:
 
             Stage(Scene & scene) : engine::Stage(scene)
             {
-                subsystem = nullptr;
+                subsystem     = nullptr;
+                running       = false;
+                camera_moving = false;
             }
-            Stage(const Stage&) = delete;
-            Stage& operator=(const Stage&) = delete;
+
+            Stage(const Stage & ) = delete;
+            Stage & operator = (const Stage & ) = delete;
+
             void prepare ()      override;
             void compute (float) override;
-            void cleanup()override;
-
+            void cleanup ()      override;
 
         private:
 
+            void start_frame ();
+
+            void trace_frame (unsigned viewport_width, unsigned viewport_height);
+
+            bool cameras_changed () const;
+
             void update_component_transforms ();
-            std::thread framebuffer_thread;
-            std::atomic<bool> running;
-            std::atomic<bool> framebuffer_ready = false;
-            std::mutex framebuffer_mutex;
-            
+
+            void trace_all_views (unsigned viewport_width, unsigned viewport_height);
+
+            void compose_views (Frame & frame, unsigned viewport_width, unsigned viewport_height);
+
         };
 
         friend class Stage;
 
     public:
 
-        using Color    = raytracer::Color;
-        using Material = raytracer::Material;
+        using Color            = raytracer::Color;
+        using Material         = raytracer::Material;
+        using Interleaving     = raytracer::Path_Tracer::Interleaving;
+        using Sampling_Pattern = raytracer::Path_Tracer::Sampling_Pattern;
+        using Trace_Report     = raytracer::Path_Tracer::Trace_Report;
 
         struct Camera : public Component
         {
@@ -80,22 +119,42 @@ namespace udit::engine
             raytracer::Model * instance = nullptr;
             raytracer::Scene * path_tracer_scene = nullptr;
 
-            Material * add_diffuse_material  (const Color   & color);
-            Material * add_metallic_material (const Color   & color,  float diffusion);
+            Material * add_diffuse_material  (const Color   & color,  const raytracer::Texture * texture = nullptr);
+            Material * add_metallic_material (const Color   & color,  float diffusion, const raytracer::Texture * texture = nullptr);
             void       add_sphere            (const Vector3 & center, float radius, Material * material);
             void       add_plane             (const Vector3 & point,  const Vector3 & normal, Material * material);
         };
 
+        // Vista adicional: otra cámara de la escena que se traza a la vez que la principal y se
+        // muestra en el rectángulo dado de la ventana (en fracciones de su tamaño). Comparte con
+        // las demás la escena y su estructura espacial; solo tiene aparte sus búferes.
+
+        struct View
+        {
+            raytracer::Path_Tracer   tracer;
+            raytracer::Camera      * camera;
+            float                    x;
+            float                    y;
+            float                    width;
+            float                    height;
+        };
+
     private:
 
         Component_Store< Camera > camera_components;
         Component_Store< Model  >  model_components;
 
-        raytracer::Path_Tracer    path_tracer;
-        raytracer::Scene          path_tracer_scene;
-        raytracer::Linear_Space   path_tracer_space;
+        raytracer::Path_Tracer         path_tracer;
+        raytracer::Scene               path_tracer_scene;
+        raytracer::Linear_Space        path_tracer_space;
+        raytracer::Cancellation_Token  frame_cancellation;
+
+        std::vector< std::unique_ptr< View > > views;
+        bool                                   main_view_visible;
 
         unsigned int              rays_per_pixel;
+        float                     time_budget;          // Segundos por fotograma (0 = rays_per_pixel pasadas completas)
+        Trace_Report              last_report;
 
     public:
 
@@ -108,6 +167,58 @@ namespace udit::engine
             rays_per_pixel = new_rays_per_pixel;
         }
 
+        // Con un presupuesto de tiempo cada fotograma traza lo que le da tiempo y el siguiente
+        // continúa por donde lo dejó, de modo que el motor mantiene la frecuencia de fotogramas
+        // sea cual sea el coste de la escena.
+
+        void set_time_budget (float seconds)
+        {
+            time_budget = seconds;
+        }
+
+        const Trace_Report & get_last_trace_report () const
+        {
+            return last_report;
+        }
+
+        void set_sampling_pattern (Sampling_Pattern new_sampling_pattern)
+        {
+            path_tracer.set_sampling_pattern (new_sampling_pattern);
+
+            for (auto & view : views) view->tracer.set_sampling_pattern (new_sampling_pattern);
+        }
+
+        // Mientras se mueve la cámara se traza solo una parte de los píxeles en cada fotograma
+
+        void set_interleaving (Interleaving new_interleaving)
+        {
+            path_tracer.set_interleaving (new_interleaving);
+
+            for (auto & view : views) view->tracer.set_interleaving (new_interleaving);
+        }
+
+        // Añade una vista desde camera que se muestra encima de la principal (por ejemplo, una
+        // miniatura o la mitad de una pantalla partida). Mientras haya vistas se trazan siempre
+        // rays_per_pixel muestras por píxel: el presupuesto de tiempo solo se aplica sin ellas.
+        // La vista principal es siempre la del primer componente Camera que se crea, por lo que
+        // crear otras cámaras para las vistas no la cambia.
+
+        View * add_view (Camera * camera, float x, float y, float width, float height);
+
+        // Si las vistas cubren toda la ventana, la principal se puede dejar de trazar
+
+        void show_main_view (bool visible)
+        {
+            main_view_visible = visible;
+        }
+
+        bool load_environment_map (const std::string & path, float intensity = 1.f);
+
+        // Carga una textura preparada con raytracer::Texture::convert(). Si no se puede cargar se
+        // devuelve igualmente y los materiales que la usen no cambian de color.
+
+        raytracer::Texture * load_texture (const std::string & path);
+
     public:
 
         Component * create_camera_component (Entity & entity, Camera::Sensor_Type sensor_type, float focal_length);
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace udit::engine
+{
+
+    // Intercambio de fotogramas entre un productor y un consumidor sin bloqueos. El productor
+    // escribe siempre en el búfer trasero y lo publica intercambiándolo por el intermedio. El
+    // consumidor se queda con el intermedio solo si tiene algo nuevo. Ninguno espera nunca al otro:
+    // el productor no se detiene aunque el consumidor vaya lento (los fotogramas que no llega a
+    // leer se sustituyen) y el consumidor siempre lee el último fotograma completo.
+
+    template< typename TYPE >
+    class Triple_Buffer
+    {
+        static constexpr uint8_t index_mask = 0b011;
+        static constexpr uint8_t fresh_bit  = 0b100;        // El intermedio aún no lo ha leído el consumidor
+
+        std::array< TYPE, 3 >                    buffers;
+        uint8_t                                  back  = 0;         // Solo lo usa el productor
+        uint8_t                                  front = 1;         // Solo lo usa el consumidor
+
+        alignas(64) std::atomic< uint8_t  >      middle       { 2 };
+        alignas(64) std::atomic< uint32_t >      publications { 0 };
+
+    public:
+
+        // Productor
+
+        TYPE & get_back_buffer ()
+        {
+            return buffers[back];
+        }
+
+        void publish ()
+        {
+            back = middle.exchange (back | fresh_bit, std::memory_order_acq_rel) & index_mask;
+
+            publications.fetch_add (1, std::memory_order_release);
+            publications.notify_all ();
+        }
+
+        // Consumidor
+
+        // Pasa al búfer delantero el último fotograma publicado. Devuelve false si no había
+        // ninguno nuevo desde la última vez (el delantero no cambia).
+
+        bool acquire ()
+        {
+            if ((middle.load (std::memory_order_relaxed) & fresh_bit) == 0) return false;
+
+            front = middle.exchange (front, std::memory_order_acq_rel) & index_mask;
+
+            return true;
+        }
+
+        const TYPE & get_front_buffer () const
+        {
+            return buffers[front];
+        }
+
+        uint32_t get_publication_count () const
+        {
+            return publications.load (std::memory_order_acquire);
+        }
+
+        // Espera sin consumir CPU a que el contador de publicaciones deje de valer seen
+
+        void wait_for_publication (uint32_t seen) const
+        {
+            publications.wait (seen, std::memory_order_acquire);
+        }
+
+        // Despierta al consumidor sin publicar nada (por ejemplo, para que termine)
+
+        void wake ()
+        {
+            publications.fetch_add (1, std::memory_order_release);
+            publications.notify_all ();
+        }
+
+    };
+
+}
@@ -10,15 +10,15 @@
 #include <engine/Window.hpp>
 
 #include <raytracer/Diffuse_Material.hpp>
+#include <raytracer/Environment_Map.hpp>
 #include <raytracer/Metallic_Material.hpp>
 #include <raytracer/Pinhole_Camera.hpp>
 #include <raytracer/Plane.hpp>
 #include <raytracer/Sphere.hpp>
 #include <raytracer/Skydome.hpp>
+#include <raytracer/Texture.hpp>
 #include <execution>        //Para std::execution::par (concurrencia)
 #include <algorithm>        //Para std::for_each
-#include <mutex>
-#include <atomic>
 #include <chrono>
 
 namespace udit::engine
@@ -104,9 +104,52 @@ namespace udit::engine
     :
         Subsystem(scene),
         path_tracer_space(path_tracer_scene),
-        rays_per_pixel(1)
+        main_view_visible(true),
+        rays_per_pixel(1),
+        time_budget(0.f)
     {
         path_tracer_scene.create< raytracer::Skydome > (raytracer::Color{.5f, .75f, 1.f}, raytracer::Color{1, 1, 1});
+
+        path_tracer.set_cancellation_token (&frame_cancellation);
+    }
+
+    // Sustituye el cielo por una imagen HDR. Si no se puede cargar se mantiene el degradado.
+
+    bool Path_Tracing::load_environment_map (const std::string & path, float intensity)
+    {
+        auto environment_map = path_tracer_scene.create< raytracer::Environment_Map > (path, intensity);
+
+        if (not environment_map->is_loaded ())
+        {
+            path_tracer_scene.create< raytracer::Skydome > (raytracer::Color{.5f, .75f, 1.f}, raytracer::Color{1, 1, 1});
+
+            return false;
+        }
+
+        return true;
+    }
+
+    raytracer::Texture * Path_Tracing::load_texture (const std::string & path)
+    {
+        return path_tracer_scene.create< raytracer::Texture > (path);
+    }
+
+    Path_Tracing::View * Path_Tracing::add_view (Camera * camera, float x, float y, float width, float height)
+    {
+        auto & view = views.emplace_back (std::make_unique< View > ());
+
+        view->camera = camera->instance;
+        view->x      = x;
+        view->y      = y;
+        view->width  = width;
+        view->height = height;
+
+        view->tracer.set_camera             (camera->instance);
+        view->tracer.set_cancellation_token (&frame_cancellation);
+        view->tracer.set_sampling_pattern   (path_tracer.get_sampling_pattern ());
+        view->tracer.set_interleaving       (path_tracer.get_interleaving ());
+
+        return view.get ();
     }
 
     template< >
@@ -145,75 +188,228 @@ namespace udit::engine
         return model;
     }
 
-    //Lanza un hilo para actualizar el framebuffer a 25 fps
+    // Lanza el hilo que presenta los fotogramas. Duerme hasta que se publica uno nuevo.
+
     void Path_Tracing::Stage::prepare ()
     {
         subsystem = scene.get_subsystem< Path_Tracing > ();
-        running = true;
+        running   = true;
 
-        auto& window = scene.get_window();
-        
-        // Se lanza un hilo secundario que actualizará la imagen renderizada cada 40ms (25 FPS)
-        framebuffer_thread = std::thread([this, &window]()
+        auto & window = scene.get_window ();
+
+        presentation_thread = std::thread([this, &window] ()
             {
-                using namespace std::chrono;
+                uint32_t seen_publications = frames.get_publication_count ();
 
                 while (running)
                 {
-                    auto start = steady_clock::now();
+                    frames.wait_for_publication (seen_publications);
+
+                    seen_publications = frames.get_publication_count ();
 
-                    if (framebuffer_ready)
+                    if (running && frames.acquire ())
                     {
-                        const float* snapshot_data = nullptr;
-                        int width, height;
-
-                        {
-                            // Se protege el acceso a los datos del framebuffer con mutex
-                            std::lock_guard<std::mutex> lock(framebuffer_mutex);
-
-                            snapshot_data = reinterpret_cast<const float*>(subsystem->path_tracer.get_snapshot().data());
-                            width = window.get_width();
-                            height = window.get_height();
-                        }
-
-                        // No accedemos a la escena ni al path tracer dentro del lock
-                        if (snapshot_data)
-                        {
-                            window.blit_rgb_float(snapshot_data, width, height);
-                        }
+                        auto & frame = frames.get_front_buffer ();
+
+                        window.blit_rgb_float (frame.data (), frame.get_width (), frame.get_height ());
                     }
-                    //Espera activa para mantener una frecuencia de actualización de 25 FPS
-                    std::this_thread::sleep_until(start + milliseconds(40));
                 }
             });
     }
 
+    // Mientras se traza un fotograma, el hilo principal sigue con la entrada y el control. Si
+    // entretanto cambia alguna cámara, el fotograma ya no corresponde a lo que se va a ver y se
+    // cancela. Solo se cancela cuando la cámara estaba quieta al empezar: si ya se movía, se deja
+    // terminar para que se vea algo mientras se mueve de forma continua.
+
     void Path_Tracing::Stage::compute (float)
     {
         if (subsystem)
         {
-            auto & window          =  scene.get_window ();
-            auto   viewport_width  = window.get_width  ();
-            auto   viewport_height = window.get_height ();
+            if (tracing.valid ())
+            {
+                if (tracing.wait_for (polling_interval) == std::future_status::timeout)
+                {
+                    if (not camera_moving && cameras_changed ()) subsystem->frame_cancellation.request ();
 
-            update_component_transforms ();// Se actualizan las transformaciones de los modelos y cámaras
+                    return;
+                }
 
+                tracing.get ();
+            }
+
+            start_frame ();
+        }
+    }
+
+    // Las transformaciones solo se pasan a la escena del trazador entre fotogramas, cuando nadie
+    // la está leyendo
+
+    void Path_Tracing::Stage::start_frame ()
+    {
+        auto & window          =  scene.get_window ();
+        auto   viewport_width  = window.get_width  ();
+        auto   viewport_height = window.get_height ();
+
+        // Nadie más pide la cancelación, por lo que no se pierde ninguna pedida para este fotograma
+        subsystem->frame_cancellation.reset ();
+
+        camera_moving = cameras_changed ();
+
+        traced_cameras.clear ();
+
+        for (auto & camera : subsystem->camera_components)
+        {
+            traced_cameras.push_back (*subsystem->scene.get_component< Transform > (camera.entity_id));
+        }
+
+        update_component_transforms ();// Se actualizan las transformaciones de los modelos y cámaras
+
+        tracing = std::async
+        (
+            std::launch::async,
+            [this, viewport_width, viewport_height] () { trace_frame (viewport_width, viewport_height); }
+        );
+    }
+
+    void Path_Tracing::Stage::trace_frame (unsigned viewport_width, unsigned viewport_height)
+    {
+        if (not subsystem->views.empty ())
+        {
+            trace_all_views (viewport_width, viewport_height);
+
+            for (auto & view : subsystem->views)
             {
-                // Se traza la imagen completa y se marca como lista para mostrar
-                subsystem ->path_tracer.trace(subsystem->path_tracer_space, viewport_width, viewport_height, subsystem->rays_per_pixel);
-                // Se notifica al hilo de que ya hay imagen nueva lista
-                framebuffer_ready = true;
+                if (view->tracer.was_cancelled ()) return;
             }
+
+            if (subsystem->main_view_visible && subsystem->path_tracer.was_cancelled ()) return;
+
+            compose_views (frames.get_back_buffer (), viewport_width, viewport_height);
+
+            frames.publish ();
         }
+        else
+        {
+            // Se traza la imagen (completa o lo que dé tiempo) y se marca como lista para mostrar
+            if (subsystem->time_budget > 0.f)
+            {
+                auto deadline = std::chrono::steady_clock::now ()
+                              + std::chrono::duration_cast< std::chrono::steady_clock::duration > (std::chrono::duration< float >(subsystem->time_budget));
+
+                subsystem->last_report = subsystem->path_tracer.trace_until (subsystem->path_tracer_space, viewport_width, viewport_height, deadline);
+            }
+            else
+            {
+                subsystem->path_tracer.trace (subsystem->path_tracer_space, viewport_width, viewport_height, subsystem->rays_per_pixel);
+            }
+
+            // Un fotograma cancelado no se muestra: sigue en pantalla el anterior
+
+            if (subsystem->path_tracer.was_cancelled ()) return;
+
+            // La instantánea se escribe directamente en el búfer trasero, que el hilo de
+            // presentación no toca hasta que se publica
+            subsystem->path_tracer.copy_snapshot (frames.get_back_buffer ());
+
+            frames.publish ();
+        }
+    }
+
+    // Compara las transformaciones actuales de las cámaras con las del fotograma en curso
+
+    bool Path_Tracing::Stage::cameras_changed () const
+    {
+        size_t index = 0;
+
+        for (auto & camera : subsystem->camera_components)
+        {
+            if (index == traced_cameras.size ()) return true;
+
+            auto & current = *subsystem->scene.get_component< Transform > (camera.entity_id);
+            auto & traced  = traced_cameras[index++];
+
+            if (current.position != traced.position || current.rotation != traced.rotation || current.scales != traced.scales)
+            {
+                return true;
+            }
+        }
+
+        return index != traced_cameras.size ();
+    }
+
+    // Todas las vistas se trazan juntas, repartiendo sus píxeles entre los mismos hilos
+
+    void Path_Tracing::Stage::trace_all_views (unsigned viewport_width, unsigned viewport_height)
+    {
+        std::vector< raytracer::Path_Tracer::View > views;
+
+        if (subsystem->main_view_visible)
+        {
+            views.push_back ({ &subsystem->path_tracer, viewport_width, viewport_height, subsystem->rays_per_pixel });
+        }
+
+        for (auto & view : subsystem->views)
+        {
+            unsigned width  = std::max (1u, unsigned(view->width  * float(viewport_width )));
+            unsigned height = std::max (1u, unsigned(view->height * float(viewport_height)));
+
+            views.push_back ({ &view->tracer, width, height, subsystem->rays_per_pixel });
+        }
+
+        raytracer::Path_Tracer::trace_views (subsystem->path_tracer_space, views);
     }
-    void Path_Tracing::Stage::cleanup()
+
+    // Cada vista se copia en su rectángulo sobre la principal (o sobre negro si no se muestra),
+    // en el orden en que se añadieron
+
+    void Path_Tracing::Stage::compose_views (Frame & frame, unsigned viewport_width, unsigned viewport_height)
     {
-        running = false; // Se indica al hilo que debe detenerse
+        if (subsystem->main_view_visible)
+        {
+            subsystem->path_tracer.copy_snapshot (frame);
+        }
+        else
+        {
+            frame.set_layout (raytracer::Buffer_Layout::ROW_MAJOR);
+            frame.resize     (viewport_width, viewport_height);
+            frame.clear      (raytracer::Color(0, 0, 0));
+        }
 
-        if (framebuffer_thread.joinable())
-            framebuffer_thread.join();      // Esperamos a que termine correctamente
+        for (auto & view : subsystem->views)
+        {
+            auto & snapshot = view->tracer.get_snapshot ();
+            auto   left     = unsigned(view->x * float(viewport_width ));
+            auto   top      = unsigned(view->y * float(viewport_height));
+            auto   width    = std::min (snapshot.get_width  (), viewport_width  - std::min (left, viewport_width ));
+            auto   height   = std::min (snapshot.get_height (), viewport_height - std::min (top,  viewport_height));
+
+            for (unsigned y = 0; y < height; ++y)
+            {
+                for (unsigned x = 0; x < width; ++x)
+                {
+                    frame.set (left + x, top + y, snapshot.get (x, y));
+                }
+            }
+        }
     }
-    
+
+    void Path_Tracing::Stage::cleanup ()
+    {
+        if (tracing.valid ())
+        {
+            subsystem->frame_cancellation.request ();
+
+            tracing.get ();
+        }
+
+        running = false;
+
+        frames.wake ();
+
+        if (presentation_thread.joinable ()) presentation_thread.join ();
+    }
+
     //Transformaciones modificadas para concurrencia
     void Path_Tracing::Stage::update_component_transforms ()
     {
@@ -240,14 +436,14 @@ namespace udit::engine
             });
     }
 
-    Path_Tracing::Material * Path_Tracing::Model::add_diffuse_material  (const Color & color)
+    Path_Tracing::Material * Path_Tracing::Model::add_diffuse_material  (const Color & color, const raytracer::Texture * texture)
     {
-        return path_tracer_scene->create< raytracer::Diffuse_Material > (color);
+        return path_tracer_scene->create< raytracer::Diffuse_Material > (color, texture);
     }
 
-    Path_Tracing::Material * Path_Tracing::Model::add_metallic_material (const Color & color, float diffusion)
+    Path_Tracing::Material * Path_Tracing::Model::add_metallic_material (const Color & color, float diffusion, const raytracer::Texture * texture)
     {
-        return path_tracer_scene->create< raytracer::Metallic_Material > (color, diffusion);
+        return path_tracer_scene->create< raytracer::Metallic_Material > (color, diffusion, texture);
     }
 
     void Path_Tracing::Model::add_sphere (const Vector3 & center, float radius, Material * material)
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace udit::raytracer
+{
+
+    struct Arena_Statistics
+    {
+        size_t bytes_used     = 0;              // Ocupados por objetos vivos
+        size_t bytes_wasted   = 0;              // Sobrantes al final de segmentos llenos
+        size_t bytes_reserved = 0;              // Total pedido al sistema
+        size_t segments       = 0;
+        size_t objects        = 0;
+
+        Arena_Statistics & operator += (const Arena_Statistics & other)
+        {
+            bytes_used     += other.bytes_used;
+            bytes_wasted   += other.bytes_wasted;
+            bytes_reserved += other.bytes_reserved;
+            segments       += other.segments;
+            objects        += other.objects;
+
+            return *this;
+        }
+    };
+
+    // Interfaz común para poder guardar arenas de distintos tipos en un mismo contenedor.
+
+    class Base_Arena
+    {
+    public:
+
+        virtual ~Base_Arena() = default;
+
+        virtual void reset () = 0;
+
+        virtual Arena_Statistics get_statistics () const = 0;
+    };
+
+    // Arena de objetos de un único tipo. Los objetos se colocan contiguos dentro de segmentos
+    // alineados a la alineación del tipo (y, como mínimo, a la línea de caché), por lo que cada
+    // segmento es un array homogéneo. Los destructores se ejecutan todos juntos en reset().
+
+    template< typename TYPE >
+    class Arena : public Base_Arena
+    {
+    public:
+
+        using Value_Type = TYPE;
+
+        static constexpr size_t default_segment_size = 65536u;
+        static constexpr size_t cache_line_size      = 64u;
+        static constexpr size_t alignment            = std::max (alignof(TYPE), cache_line_size);
+
+    private:
+
+        struct Segment
+        {
+            TYPE * objects;
+            size_t count;
+        };
+
+        std::vector< Segment > segments;
+
+        size_t current;                         // Segmento en el que se está asignando
+        size_t segment_capacity;                // En número de objetos
+
+    public:
+
+        Arena(size_t desired_segment_size = default_segment_size)
+        {
+            current          = 0;
+            segment_capacity = std::max< size_t > (1, desired_segment_size / sizeof(TYPE));
+        }
+
+       ~Arena()
+        {
+            release ();
+        }
+
+        Arena(const Arena & ) = delete;
+        Arena & operator = (const Arena & ) = delete;
+
+    public:
+
+        template< typename ...ARGUMENTS >
+        TYPE * create (ARGUMENTS && ...arguments)
+        {
+            if (segments.empty () || segments[current].count == segment_capacity)
+            {
+                next_segment ();
+            }
+
+            auto & segment = segments[current];
+            auto   object  = new (segment.objects + segment.count) TYPE(std::forward< ARGUMENTS > (arguments)...);
+
+            segment.count++;
+
+            return object;
+        }
+
+        // Destruye todos los objetos pero conserva los segmentos para reutilizarlos.
+
+        void reset () override
+        {
+            for (auto & segment : segments)
+            {
+                if constexpr (not std::is_trivially_destructible_v< TYPE >)
+                {
+                    for (size_t index = 0; index < segment.count; ++index)
+                    {
+                        segment.objects[index].~TYPE ();
+                    }
+                }
+
+                segment.count = 0;
+            }
+
+            current = 0;
+        }
+
+        // Destruye todos los objetos y devuelve la memoria al sistema.
+
+        void release ()
+        {
+            reset ();
+
+            for (auto & segment : segments)
+            {
+                ::operator delete (segment.objects, std::align_val_t(alignment));
+            }
+
+            segments.clear ();
+        }
+
+        Arena_Statistics get_statistics () const override
+        {
+            Arena_Statistics statistics;
+
+            for (size_t index = 0; index < segments.size (); ++index)
+            {
+                statistics.objects    += segments[index].count;
+                statistics.bytes_used += segments[index].count * sizeof(TYPE);
+
+                if (index < current)
+                {
+                    statistics.bytes_wasted += segment_bytes () - segments[index].count * sizeof(TYPE);
+                }
+            }
+
+            statistics.segments       = segments.size ();
+            statistics.bytes_reserved = segments.size () * segment_bytes ();
+
+            return statistics;
+        }
+
+    private:
+
+        size_t segment_bytes () const
+        {
+            return (segment_capacity * sizeof(TYPE) + alignment - 1) / alignment * alignment;
+        }
+
+        void next_segment ()
+        {
+            if (not segments.empty () && current + 1 < segments.size ())
+            {
+                ++current;                      // Se reutiliza un segmento que quedó libre tras reset()
+            }
+            else
+            {
+                auto memory = ::operator new (segment_bytes (), std::align_val_t(alignment));
+
+                segments.push_back ({ static_cast< TYPE * >(memory), 0 });
+
+                current = segments.size () - 1;
+            }
+        }
+
+    };
+
+}
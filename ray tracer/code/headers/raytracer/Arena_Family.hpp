@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <raytracer/Arena.hpp>
+
+namespace udit::raytracer
+{
+
+    // Conjunto de arenas con una arena por tipo y por hilo. Cada hilo crea sus objetos en sus
+    // propias arenas, de modo que create() no necesita bloqueos salvo la primera vez que un hilo
+    // la usa. reset(), release() y get_statistics() afectan a todos los hilos y solo deben
+    // llamarse cuando ningún hilo esté creando objetos.
+
+    class Arena_Family
+    {
+        using Arena_Ptr  = std::unique_ptr< Base_Arena >;
+        using Arena_List = std::vector< Arena_Ptr >;
+
+        struct Thread_Arenas
+        {
+            Arena_List arenas;                  // Indexadas por el índice de cada tipo
+        };
+
+        using Thread_Arenas_Ptr  = std::unique_ptr< Thread_Arenas >;
+        using Thread_Arenas_List = std::vector< Thread_Arenas_Ptr >;
+
+    private:
+
+        static inline std::atomic< size_t   > next_type_index   { 0 };
+        static inline std::atomic< uint64_t > next_family_index { 1 };
+
+        const uint64_t     family_index;
+        const size_t       segment_size;
+
+        std::mutex         mutex;
+        Thread_Arenas_List thread_arenas;
+
+    public:
+
+        Arena_Family(size_t desired_segment_size = Arena< std::byte >::default_segment_size)
+        :
+            family_index(next_family_index++),
+            segment_size(desired_segment_size)
+        {
+        }
+
+        Arena_Family(const Arena_Family & ) = delete;
+        Arena_Family & operator = (const Arena_Family & ) = delete;
+
+    public:
+
+        template< typename TYPE, typename ...ARGUMENTS >
+        TYPE * create (ARGUMENTS && ...arguments)
+        {
+            return get_arena< TYPE > ().create (std::forward< ARGUMENTS > (arguments)...);
+        }
+
+        template< typename TYPE >
+        Arena< TYPE > & get_arena ()
+        {
+            auto & arenas = get_thread_arenas ().arenas;
+            auto   index  = type_index< TYPE > ();
+
+            if (index >= arenas.size ())
+            {
+                arenas.resize (index + 1);
+            }
+
+            if (not arenas[index])
+            {
+                arenas[index] = std::make_unique< Arena< TYPE > > (segment_size);
+            }
+
+            return static_cast< Arena< TYPE > & >(*arenas[index]);
+        }
+
+    public:
+
+        void reset ()
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            for (auto & thread : thread_arenas)
+            {
+                for (auto & arena : thread->arenas)
+                {
+                    if (arena) arena->reset ();
+                }
+            }
+        }
+
+        void release ()
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            for (auto & thread : thread_arenas)
+            {
+                thread->arenas.clear ();
+            }
+        }
+
+        Arena_Statistics get_statistics ()
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            Arena_Statistics statistics;
+
+            for (auto & thread : thread_arenas)
+            {
+                for (auto & arena : thread->arenas)
+                {
+                    if (arena) statistics += arena->get_statistics ();
+                }
+            }
+
+            return statistics;
+        }
+
+    private:
+
+        template< typename TYPE >
+        static size_t type_index ()
+        {
+            static const size_t index = next_type_index++;
+
+            return index;
+        }
+
+        // Cada hilo recuerda en qué arenas de cada familia está trabajando. Los índices de familia
+        // no se reutilizan, así que las entradas de familias ya destruidas nunca vuelven a coincidir.
+
+        Thread_Arenas & get_thread_arenas ()
+        {
+            thread_local std::vector< std::pair< uint64_t, Thread_Arenas * > > cache;
+
+            for (auto & entry : cache)
+            {
+                if (entry.first == family_index) return *entry.second;
+            }
+
+            std::lock_guard< std::mutex > lock(mutex);
+
+            thread_arenas.push_back (std::make_unique< Thread_Arenas > ());
+
+            cache.emplace_back (family_index, thread_arenas.back ().get ());
+
+            return *thread_arenas.back ();
+        }
+
+    };
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <array>
+
+#include <raytracer/Sampler.hpp>
+#include <raytracer/Sobol_Sampler.hpp>
+
+namespace udit::raytracer
+{
+
+    // Todos los píxeles recorren la misma secuencia de Sobol (aleatorizada con una semilla global)
+    // desplazada módulo 1 por el valor de una máscara de ruido azul, que cambia de posición en cada
+    // dimensión. El error que queda en la imagen se distribuye como ruido azul (de alta
+    // frecuencia), que a igualdad de muestras se percibe mucho menos que el ruido blanco.
+
+    class Blue_Noise_Sampler final : public Sampler
+    {
+    public:
+
+        static constexpr unsigned mask_size = 64;
+
+        using Mask = std::array< float, mask_size * mask_size >;
+
+    private:
+
+        const Mask & mask;
+
+        uint32_t seed;
+        unsigned x;
+        unsigned y;
+        uint32_t sample_index;
+        uint32_t dimension;
+
+    public:
+
+        Blue_Noise_Sampler(uint32_t given_seed = 0) : mask(get_mask ())
+        {
+            seed         = given_seed;
+            x            = 0;
+            y            = 0;
+            sample_index = 0;
+            dimension    = 0;
+        }
+
+        void start (unsigned given_x, unsigned given_y, uint32_t given_sample_index) override
+        {
+            x            = given_x;
+            y            = given_y;
+            sample_index = given_sample_index;
+            dimension    = 0;
+        }
+
+        float get_1d () override
+        {
+            return sample (dimension++);
+        }
+
+        Vector2 get_2d () override
+        {
+            dimension += dimension & 1;
+
+            float first  = sample (dimension++);
+            float second = sample (dimension++);
+
+            return Vector2(first, second);
+        }
+
+    public:
+
+        // Máscara de 64 x 64 generada con el algoritmo void-and-cluster de Ulichney la primera vez
+        // que se necesita. Cada valor es el rango del texel dividido por el número de texels.
+
+        static const Mask & get_mask ();
+
+    private:
+
+        float sample (uint32_t dimension) const
+        {
+            uint32_t group     = dimension / Sobol_Sampler::dimensions_per_group;
+            uint32_t component = dimension % Sobol_Sampler::dimensions_per_group;
+            uint32_t group_seed = hash (seed, group);
+            uint32_t index      = Sobol_Sampler::nested_uniform_scramble (sample_index, group_seed);
+            float    value      = to_float (Sobol_Sampler::nested_uniform_scramble (Sobol_Sampler::sobol (index, component), hash (group_seed, component)));
+
+            uint32_t offset = hash (seed ^ 0xB1AE5EEDu, dimension);
+            unsigned mask_x = (x + (offset      )) % mask_size;
+            unsigned mask_y = (y + (offset >> 16)) % mask_size;
+
+            value += mask[mask_y * mask_size + mask_x];
+
+            return value < 1.f ? value : value - 1.f;
+        }
+    };
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include <raytracer/math.hpp>
+#include <raytracer/Ray.hpp>
+
+namespace udit::raytracer
+{
+
+    struct Bounding_Box
+    {
+        Vector3 min;
+        Vector3 max;
+
+        Bounding_Box()
+        :
+            min(+std::numeric_limits< float >::infinity ()),
+            max(-std::numeric_limits< float >::infinity ())
+        {
+        }
+
+        Bounding_Box(const Vector3 & given_min, const Vector3 & given_max)
+        :
+            min(given_min),
+            max(given_max)
+        {
+        }
+
+    public:
+
+        bool is_empty () const
+        {
+            return min.x > max.x || min.y > max.y || min.z > max.z;
+        }
+
+        void extend (const Vector3 & point)
+        {
+            min = glm::min (min, point);
+            max = glm::max (max, point);
+        }
+
+        void extend (const Bounding_Box & other)
+        {
+            min = glm::min (min, other.min);
+            max = glm::max (max, other.max);
+        }
+
+    public:
+
+        // Test de slabs: indica si el rayo atraviesa la caja dentro del intervalo [min_t, max_t].
+        // Los tres ejes se calculan a la vez y sin saltos para que el compilador use registros
+        // vectoriales; el resultado es el mismo que recortando el intervalo eje a eje.
+
+        bool intersects (const Ray & ray, float min_t, float max_t) const
+        {
+            Vector3 t0 = (min - ray.origin) * ray.inverse_direction;
+            Vector3 t1 = (max - ray.origin) * ray.inverse_direction;
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                bool  negative = ray.inverse_direction[axis] < 0.f;
+                float near_t   = negative ? t1[axis] : t0[axis];
+                float far_t    = negative ? t0[axis] : t1[axis];
+
+                min_t = near_t > min_t ? near_t : min_t;
+                max_t = far_t  < max_t ? far_t  : max_t;
+            }
+
+            return not (max_t < min_t);
+        }
+
+    };
+
+}
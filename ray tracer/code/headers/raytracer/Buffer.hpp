@@ -8,11 +8,78 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__linux__)
+    #include <sys/mman.h>
+#endif
+
 namespace udit::raytracer
 {
 
+    // Orden en el que se guardan los elementos. En TILED la imagen se divide en baldosas de
+    // Buffer_Tiles::size x Buffer_Tiles::size elementos consecutivos en memoria, que se recorren en
+    // orden de Morton, de forma que los píxeles cercanos en la imagen también lo están en memoria.
+
+    enum class Buffer_Layout
+    {
+        ROW_MAJOR,
+        TILED,
+    };
+
+    struct Buffer_Tiles
+    {
+        static constexpr unsigned size_bits = 4;
+        static constexpr unsigned size      = 1u << size_bits;
+        static constexpr unsigned area      = size * size;
+
+        static unsigned morton_encode (unsigned x, unsigned y)
+        {
+            return spread (x) | (spread (y) << 1);
+        }
+
+        static void morton_decode (unsigned code, unsigned & x, unsigned & y)
+        {
+            x = compact (code     );
+            y = compact (code >> 1);
+        }
+
+    private:
+
+        static unsigned spread (unsigned value)
+        {
+            value &= 0x0000FFFFu;
+            value  = (value | (value << 8)) & 0x00FF00FFu;
+            value  = (value | (value << 4)) & 0x0F0F0F0Fu;
+            value  = (value | (value << 2)) & 0x33333333u;
+            value  = (value | (value << 1)) & 0x55555555u;
+
+            return value;
+        }
+
+        static unsigned compact (unsigned value)
+        {
+            value &= 0x55555555u;
+            value  = (value | (value >> 1)) & 0x33333333u;
+            value  = (value | (value >> 2)) & 0x0F0F0F0Fu;
+            value  = (value | (value >> 4)) & 0x00FF00FFu;
+            value  = (value | (value >> 8)) & 0x0000FFFFu;
+
+            return value;
+        }
+    };
+
+    // Los elementos se alinean a 64 bytes (una línea de caché) y, si el búfer es grande, a 2 MB
+    // pidiendo al sistema que use páginas grandes. Se inicializan en paralelo por páginas.
+    // También puede usar memoria ajena (ver attach()), como la de un fichero proyectado en memoria.
+
     template< typename TYPE >
     class Buffer
     {
@@ -20,38 +87,89 @@ namespace udit::raytracer
 
         using Value_Type = TYPE;
 
+        static constexpr size_t alignment      = std::max< size_t > (64, alignof(TYPE));
+        static constexpr size_t page_size      = 4096;
+        static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
     private:
 
-        unsigned width;
-        unsigned height;
+        unsigned      width;
+        unsigned      height;
+        Buffer_Layout layout;
+        size_t        count;
 
-        std::vector< Value_Type > elements;
+        Value_Type  * elements;
+        bool          owner;                    // false si los elementos son memoria ajena
 
     public:
 
-        Buffer()
+        Buffer(Buffer_Layout given_layout = Buffer_Layout::ROW_MAJOR)
         {
-            width = height = 0;
+            width    = height = 0;
+            layout   = given_layout;
+            count    = 0;
+            elements = nullptr;
+            owner    = true;
         }
 
-        Buffer(unsigned given_width, unsigned given_height)
+        Buffer(unsigned given_width, unsigned given_height, Buffer_Layout given_layout = Buffer_Layout::ROW_MAJOR)
         :
-            width   (given_width   ),
-            height  (given_height  ),
-            elements(width * height)
+            Buffer(given_layout)
         {
+            resize (given_width, given_height);
+        }
+
+        Buffer(const Buffer & other) : Buffer(other.layout)
+        {
+            *this = other;
+        }
+
+        Buffer(Buffer && other) noexcept : Buffer(other.layout)
+        {
+            swap (other);
+        }
+
+        Buffer & operator = (const Buffer & other)
+        {
+            if (this != &other)
+            {
+                release ();
+
+                layout   = other.layout;
+                width    = other.width;
+                height   = other.height;
+                count    = other.count;
+                elements = allocate (count);
+                owner    = true;
+
+                std::uninitialized_copy_n (other.elements, count, elements);
+            }
+
+            return *this;
+        }
+
+        Buffer & operator = (Buffer && other) noexcept
+        {
+            swap (other);
+
+            return *this;
+        }
+
+       ~Buffer()
+        {
+            release ();
         }
 
     public:
 
         unsigned size () const
         {
-            return static_cast< unsigned >(elements.size ());
+            return static_cast< unsigned >(count);
         }
 
         bool empty () const
         {
-            return elements.empty ();
+            return count == 0;
         }
 
         unsigned get_width () const
@@ -64,14 +182,24 @@ namespace udit::raytracer
             return height;
         }
 
+        Buffer_Layout get_layout () const
+        {
+            return layout;
+        }
+
         Value_Type * data ()
         {
-            return elements.data ();
+            return elements;
+        }
+
+        bool owns_elements () const
+        {
+            return owner;
         }
 
         const Value_Type * data () const
         {
-            return elements.data ();
+            return elements;
         }
 
     public:
@@ -82,29 +210,87 @@ namespace udit::raytracer
             this->resize (other.get_width (), other.get_height ());
         }
 
+        // El contenido no se conserva: tras redimensionar todos los elementos tienen su valor por
+        // defecto (que, como en std::vector, es cero para los tipos triviales).
+
         void resize (unsigned new_width, unsigned new_height)
         {
             if (width != new_width || height != new_height)
             {
-                elements.resize ((width = new_width) * (height = new_height));
+                release ();
+
+                width    = new_width;
+                height   = new_height;
+                count    = size_t(width) * height;
+                elements = allocate (count);
+
+                for_each_page ([](Value_Type * first, Value_Type * last)
+                {
+                    std::uninitialized_value_construct (first, last);
+                });
+            }
+        }
+
+        // Cambiar la organización descarta el contenido.
+
+        void set_layout (Buffer_Layout new_layout)
+        {
+            if (layout != new_layout)
+            {
+                unsigned current_width  = width;
+                unsigned current_height = height;
+
+                release ();
+
+                layout = new_layout;
+
+                resize (current_width, current_height);
             }
         }
 
+        // Pasa a usar como elementos la memoria dada, que debe tener sitio para given_width x
+        // given_height elementos con la organización del búfer y vivir más que él. Su contenido se
+        // conserva. Un resize() posterior a otro tamaño vuelve a usar memoria propia.
+
+        void attach (unsigned given_width, unsigned given_height, Value_Type * storage)
+        {
+            release ();
+
+            width    = given_width;
+            height   = given_height;
+            count    = size_t(width) * height;
+            elements = storage;
+            owner    = false;
+        }
+
+        void swap (Buffer & other) noexcept
+        {
+            std::swap (width,    other.width   );
+            std::swap (height,   other.height  );
+            std::swap (layout,   other.layout  );
+            std::swap (count,    other.count   );
+            std::swap (elements, other.elements);
+            std::swap (owner,    other.owner   );
+        }
+
     public:
 
         void clear (const Value_Type & value)
         {
-            std::fill_n (elements.begin (), elements.size (), value);
+            for_each_page ([&value](Value_Type * first, Value_Type * last)
+            {
+                std::fill (first, last, value);
+            });
         }
 
         const Value_Type & get (unsigned x, unsigned y) const
         {
-            return elements[y * width + x];
+            return elements[offset_of (x, y)];
         }
 
         void set (unsigned x, unsigned y, const Value_Type & new_value)
         {
-            elements[y * width + x] = new_value;
+            elements[offset_of (x, y)] = new_value;
         }
 
         const Value_Type & get (unsigned offset) const
@@ -127,6 +313,138 @@ namespace udit::raytracer
             return elements[offset];
         }
 
+    public:
+
+        // Conversión entre coordenadas y posición en memoria según la organización del búfer.
+
+        unsigned offset_of (unsigned x, unsigned y) const
+        {
+            if (layout == Buffer_Layout::ROW_MAJOR)
+            {
+                return y * width + x;
+            }
+
+            // Las baldosas del borde derecho o inferior pueden quedar incompletas. Se guardan igual
+            // de seguidas, pero por filas, para no dejar huecos en memoria.
+
+            unsigned tile_x      = x >> Buffer_Tiles::size_bits;
+            unsigned tile_y      = y >> Buffer_Tiles::size_bits;
+            unsigned band_height = std::min (Buffer_Tiles::size, height - (tile_y << Buffer_Tiles::size_bits));
+            unsigned tile_width  = std::min (Buffer_Tiles::size, width  - (tile_x << Buffer_Tiles::size_bits));
+            unsigned local_x     = x & (Buffer_Tiles::size - 1);
+            unsigned local_y     = y & (Buffer_Tiles::size - 1);
+            unsigned tile_start  = (tile_y << Buffer_Tiles::size_bits) * width + (tile_x << Buffer_Tiles::size_bits) * band_height;
+
+            if (band_height == Buffer_Tiles::size && tile_width == Buffer_Tiles::size)
+            {
+                return tile_start + Buffer_Tiles::morton_encode (local_x, local_y);
+            }
+
+            return tile_start + local_y * tile_width + local_x;
+        }
+
+        void coordinates_of (unsigned offset, unsigned & x, unsigned & y) const
+        {
+            if (layout == Buffer_Layout::ROW_MAJOR)
+            {
+                x = offset % width;
+                y = offset / width;
+
+                return;
+            }
+
+            unsigned band_size   = width << Buffer_Tiles::size_bits;
+            unsigned tile_y      = offset / band_size;
+            unsigned band_offset = offset - tile_y * band_size;
+            unsigned band_height = std::min (Buffer_Tiles::size, height - (tile_y << Buffer_Tiles::size_bits));
+            unsigned tile_x      = band_offset / (band_height << Buffer_Tiles::size_bits);
+            unsigned tile_offset = band_offset - tile_x * (band_height << Buffer_Tiles::size_bits);
+            unsigned tile_width  = std::min (Buffer_Tiles::size, width - (tile_x << Buffer_Tiles::size_bits));
+
+            if (band_height == Buffer_Tiles::size && tile_width == Buffer_Tiles::size)
+            {
+                Buffer_Tiles::morton_decode (tile_offset, x, y);
+            }
+            else
+            {
+                x = tile_offset % tile_width;
+                y = tile_offset / tile_width;
+            }
+
+            x += tile_x << Buffer_Tiles::size_bits;
+            y += tile_y << Buffer_Tiles::size_bits;
+        }
+
+    private:
+
+        static size_t get_allocation_alignment (size_t count)
+        {
+            return count * sizeof(TYPE) >= huge_page_size ? huge_page_size : alignment;
+        }
+
+        static Value_Type * allocate (size_t count)
+        {
+            if (count == 0) return nullptr;
+
+            size_t boundary = get_allocation_alignment (count);
+            size_t bytes    = (count * sizeof(TYPE) + boundary - 1) / boundary * boundary;
+            void * memory   = ::operator new (bytes, std::align_val_t(boundary));
+
+            #if defined(__linux__) && defined(MADV_HUGEPAGE)
+
+                if (boundary == huge_page_size)
+                {
+                    madvise (memory, bytes, MADV_HUGEPAGE);
+                }
+
+            #endif
+
+            return static_cast< Value_Type * >(memory);
+        }
+
+        void release ()
+        {
+            if (elements && owner)
+            {
+                std::destroy_n (elements, count);
+
+                ::operator delete (elements, std::align_val_t(get_allocation_alignment (count)));
+            }
+
+            width    = height = 0;
+            count    = 0;
+            elements = nullptr;
+            owner    = true;
+        }
+
+        // Aplica function a trozos del tamaño de una página en paralelo
+
+        template< typename FUNCTION >
+        void for_each_page (FUNCTION function)
+        {
+            constexpr size_t elements_per_page = std::max< size_t > (1, page_size / sizeof(TYPE));
+
+            size_t number_of_pages = (count + elements_per_page - 1) / elements_per_page;
+
+            if (number_of_pages <= 1)
+            {
+                function (elements, elements + count);
+
+                return;
+            }
+
+            std::vector< size_t > pages(number_of_pages);
+            std::iota (pages.begin (), pages.end (), 0);
+
+            std::for_each (std::execution::par, pages.begin (), pages.end (), [&](size_t page)
+            {
+                size_t first = page * elements_per_page;
+                size_t last  = std::min (first + elements_per_page, count);
+
+                function (elements + first, elements + last);
+            });
+        }
+
     };
 
 }
@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <raytracer/Camera.hpp>
+#include <raytracer/math.hpp>
+
+namespace udit::raytracer
+{
+
+    // Recorrido de una cámara dado por fotogramas clave. Entre dos claves se interpola linealmente
+    // o con una curva de Catmull-Rom, que pasa por todas las claves sin cambios bruscos de
+    // velocidad (lo que conviene en los vuelos por la escena). Antes de la primera clave y después
+    // de la última la cámara se queda quieta.
+
+    class Camera_Path
+    {
+    public:
+
+        enum Interpolation
+        {
+            LINEAR,
+            CATMULL_ROM,
+        };
+
+        struct Keyframe
+        {
+            float   time;                   // Segundos
+            Vector3 position;
+            Vector3 rotation;
+            float   focal_length;
+        };
+
+    private:
+
+        std::vector< Keyframe > keyframes;          // Ordenados por tiempo
+        Interpolation           interpolation;
+
+    public:
+
+        Camera_Path(Interpolation given_interpolation = CATMULL_ROM)
+        {
+            interpolation = given_interpolation;
+        }
+
+        void add_keyframe (const Keyframe & keyframe)
+        {
+            auto position = std::upper_bound
+            (
+                keyframes.begin (), keyframes.end (), keyframe.time,
+                [](float time, const Keyframe & other) { return time < other.time; }
+            );
+
+            keyframes.insert (position, keyframe);
+        }
+
+        bool is_empty () const
+        {
+            return keyframes.empty ();
+        }
+
+        float get_duration () const
+        {
+            return keyframes.empty () ? 0.f : keyframes.back ().time - keyframes.front ().time;
+        }
+
+        float get_start_time () const
+        {
+            return keyframes.empty () ? 0.f : keyframes.front ().time;
+        }
+
+        Keyframe sample (float time) const
+        {
+            if (keyframes.size () < 2 or time <= keyframes.front ().time) return keyframes.empty () ? Keyframe{ } : keyframes.front ();
+            if (time >= keyframes.back ().time) return keyframes.back ();
+
+            size_t next = size_t
+            (
+                std::upper_bound
+                (
+                    keyframes.begin (), keyframes.end (), time,
+                    [](float time, const Keyframe & other) { return time < other.time; }
+                )
+                - keyframes.begin ()
+            );
+
+            auto & a = keyframes[next - 1];
+            auto & b = keyframes[next    ];
+            float  t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.f;
+
+            if (interpolation == LINEAR)
+            {
+                return { time, mix (a.position, b.position, t), mix (a.rotation, b.rotation, t), mix (a.focal_length, b.focal_length, t) };
+            }
+
+            // En los extremos se repite la clave para que la curva empiece y acabe en ella
+
+            auto & before = keyframes[next > 1 ? next - 2 : next - 1];
+            auto & after  = keyframes[std::min (next + 1, keyframes.size () - 1)];
+
+            return
+            {
+                time,
+                catmull_rom (before.position, a.position, b.position, after.position, t),
+                catmull_rom (before.rotation, a.rotation, b.rotation, after.rotation, t),
+                mix (a.focal_length, b.focal_length, t)
+            };
+        }
+
+        // Sitúa camera donde está el recorrido en el momento time
+
+        void apply (Camera & camera, float time) const
+        {
+            Keyframe keyframe = sample (time);
+
+            camera.transform.set_position (keyframe.position);
+            camera.transform.set_rotation (keyframe.rotation);
+            camera.set_focal_length       (keyframe.focal_length);
+        }
+
+    private:
+
+        static Vector3 catmull_rom (const Vector3 & p0, const Vector3 & p1, const Vector3 & p2, const Vector3 & p3, float t)
+        {
+            float t2 = t  * t;
+            float t3 = t2 * t;
+
+            return .5f * ((2.f * p1)
+                        + (p2 - p0) * t
+                        + (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2
+                        + (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+        }
+
+    };
+
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace udit::raytracer
+{
+
+    // Aviso de que el trabajo en curso ya no sirve. Cualquier hilo puede pedir la cancelación y
+    // quien hace el trabajo la consulta cada poco para dejarlo (ver
+    // Path_Tracer::set_cancellation_token()). Sigue pedida hasta que se llama a reset().
+
+    class Cancellation_Token
+    {
+        std::atomic< bool > requested;
+
+    public:
+
+        Cancellation_Token() : requested(false)
+        {
+        }
+
+        Cancellation_Token(const Cancellation_Token & ) = delete;
+        Cancellation_Token & operator = (const Cancellation_Token & ) = delete;
+
+        void request ()
+        {
+            requested.store (true, std::memory_order_relaxed);
+        }
+
+        void reset ()
+        {
+            requested.store (false, std::memory_order_relaxed);
+        }
+
+        bool is_requested () const
+        {
+            return requested.load (std::memory_order_relaxed);
+        }
+
+    };
+
+}
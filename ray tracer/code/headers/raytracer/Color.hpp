@@ -15,4 +15,34 @@ namespace udit::raytracer
 
     using Color = Vector3;
 
+    // Acumulación de las muestras de un píxel: su suma en rgb y cuántas son en w. Ocupa 16 bytes
+    // alineados, por lo que cada píxel se lee y se escribe con un solo acceso que nunca cruza dos
+    // líneas de caché, y los bucles sobre el búfer se pueden vectorizar.
+
+    struct alignas(16) Accumulated_Color : public Vector4
+    {
+        using Vector4::Vector4;
+
+        Accumulated_Color() : Vector4(0.f)
+        {
+        }
+
+        void add (const Color & sample)
+        {
+            *this += Vector4(sample, 1.f);
+        }
+
+        float get_sample_count () const
+        {
+            return w;
+        }
+
+        Color get_average () const
+        {
+            return Color(x, y, z) / w;
+        }
+    };
+
+    static_assert(sizeof(Accumulated_Color) == 16);
+
 }
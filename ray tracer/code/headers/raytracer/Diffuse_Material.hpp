@@ -7,32 +7,69 @@
 
 #pragma once
 
+#include <numbers>
+
 #include <raytracer/Color.hpp>
+#include <raytracer/Intersectable.hpp>
 #include <raytracer/Intersection.hpp>
 #include <raytracer/Material.hpp>
 #include <raytracer/math.hpp>
-#include <raytracer/Random.hpp>
 #include <raytracer/Ray.hpp>
+#include <raytracer/Sampler.hpp>
+#include <raytracer/Texture.hpp>
 
 namespace udit::raytracer
 {
 
-    struct Diffuse_Material : public Material
+    struct Diffuse_Material final : public Material
     {
-        Color albedo;
+        Color           albedo;
+        const Texture * texture;                // Si no es nulo, multiplica al albedo
 
-        Diffuse_Material(Color given_albedo)
+        Diffuse_Material(Color given_albedo, const Texture * given_texture = nullptr) : Material(tag_of< Diffuse_Material > ())
         {
-            albedo = given_albedo;
+            albedo  = given_albedo;
+            texture = given_texture;
         }
 
-        virtual bool scatter (const Ray & , Ray & scattered_ray, const Intersection & intersection, Color & attenuation)
+        Color get_albedo (const Intersection & intersection) const
         {
-            auto   target = intersection.point + intersection.normal + random.point_inside_sphere ();
+            if (not texture) return albedo;
+
+            auto surface = intersection.intersectable;
+            auto uv      = surface->texture_coordinates_at (intersection.point);
 
-            scattered_ray = Ray{intersection.point, target - intersection.point};
-            attenuation   = albedo;
+            return albedo * texture->sample (uv, intersection.footprint / surface->get_texture_scale ());
+        }
+
+        virtual bool scatter (const Ray & , Ray & scattered_ray, const Intersection & intersection, Color & attenuation, Sampler & sampler)
+        {
+            // Distribución proporcional al coseno, que es la que evaluate() supone
+
+            scattered_ray = Ray{intersection.point, cosine_weighted_direction (intersection.normal, sampler.get_2d ())};
+            attenuation   = get_albedo (intersection);
+
+            return true;
+        }
 
+        Color evaluate (const Ray & , const Intersection & intersection, const Vector3 & direction, float & pdf) const override
+        {
+            float cosine = dot (intersection.normal, normalize (direction));
+
+            if (cosine <= 0.f)
+            {
+                pdf = 0.f;
+
+                return Color(0, 0, 0);
+            }
+
+            pdf = cosine * std::numbers::inv_pi_v< float >;
+
+            return get_albedo (intersection) * pdf;
+        }
+
+        bool is_diffuse () const override
+        {
             return true;
         }
     };
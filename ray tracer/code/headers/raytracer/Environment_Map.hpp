@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Color.hpp>
+#include <raytracer/math.hpp>
+#include <raytracer/Sky_Environment.hpp>
+
+namespace udit::raytracer
+{
+
+    // Cielo a partir de una imagen HDR equirectangular (PFM o Radiance RGBE). La columna central
+    // de la imagen mira hacia -Z y la fila superior hacia +Y.
+    //
+    // Para muestrear por importancia las zonas brillantes se precalcula una distribución 2D
+    // constante a trozos sobre los texels (la marginal de las filas y la condicional de las
+    // columnas de cada fila), ponderada por la luminancia y por el ángulo sólido de cada fila.
+
+    class Environment_Map final : public Sky_Environment
+    {
+        using Image = Buffer< Color >;
+        using Cdf   = std::vector< float >;
+
+    private:
+
+        Image image;
+        float intensity;
+
+        Cdf   marginal_cdf;                     // height + 1 valores
+        Cdf   conditional_cdfs;                 // height filas de width + 1 valores
+        float total_weight;
+
+    public:
+
+        Environment_Map(const std::string & path, float given_intensity = 1.f);
+
+        bool is_loaded () const
+        {
+            return not image.empty ();
+        }
+
+        unsigned get_width () const
+        {
+            return image.get_width ();
+        }
+
+        unsigned get_height () const
+        {
+            return image.get_height ();
+        }
+
+    public:
+
+        Color sample (const Vector3 & direction) const override;
+
+        bool is_importance_sampled () const override
+        {
+            return total_weight > 0.f;
+        }
+
+        Color sample_direction (const Vector2 & random_point, Vector3 & direction, float & pdf) const override;
+
+        float pdf (const Vector3 & direction) const override;
+
+    private:
+
+        Color lookup (float u, float v) const;
+
+        void  build_distribution ();
+
+        static Vector2 direction_to_uv (const Vector3 & direction);
+        static Vector3 uv_to_direction (float u, float v);
+
+        static bool load_pfm  (const std::string & path, Image & image);
+        static bool load_rgbe (const std::string & path, Image & image);
+
+    };
+
+}
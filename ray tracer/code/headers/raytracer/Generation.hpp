@@ -0,0 +1,27 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace udit::raytracer
+{
+
+    using Generation         = uint32_t;
+    using Generation_Counter = std::atomic< Generation >;
+
+    // Los contadores pueden incrementarse desde varios hilos a la vez (carga en paralelo,
+    // actualización de transformaciones...). Solo importa que cambien, no el orden.
+
+    inline void advance (Generation_Counter * counter)
+    {
+        if (counter) counter->fetch_add (1, std::memory_order_relaxed);
+    }
+
+}
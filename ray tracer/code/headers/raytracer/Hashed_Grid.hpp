@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include <raytracer/math.hpp>
+
+namespace udit::raytracer
+{
+
+    // Tabla hash de celdas de una rejilla del espacio de la escena, separadas también por el eje
+    // dominante de la normal (y por lo que añada quien la usa, como el material). Se reparte entre
+    // los hilos sin bloqueos: cada celda se reserva con un compare-exchange de su clave y las
+    // colisiones se resuelven probando las siguientes posiciones. CELL debe tener un miembro
+    // std::atomic< uint64_t > key que vale 0 si la celda está libre.
+    // La usan Radiance_Cache y Path_Guide.
+
+    template< class CELL, unsigned MAXIMUM_PROBES >
+    class Hashed_Grid
+    {
+    public:
+
+        using Cell = CELL;
+
+        static constexpr unsigned maximum_probes = MAXIMUM_PROBES;     // Posiciones consecutivas que se prueban
+
+    private:
+
+        std::unique_ptr< Cell[] > cells;
+        uint64_t                  mask;
+        float                     inverse_cell_size;
+
+    public:
+
+        Hashed_Grid(float cell_size, unsigned capacity_bits)
+        :
+            cells(std::make_unique< Cell[] > (size_t(1) << capacity_bits))
+        {
+            mask = (uint64_t(1) << capacity_bits) - 1;
+
+            set_cell_size (cell_size);
+        }
+
+        void set_cell_size (float cell_size)
+        {
+            inverse_cell_size = 1.f / cell_size;
+        }
+
+        Cell * begin () { return cells.get ();            }
+        Cell * end   () { return cells.get () + mask + 1; }
+
+    public:
+
+        // Clave de la celda del punto. extra distingue celdas que comparten posición y normal.
+        // Nunca es 0, que marca las celdas libres.
+
+        uint64_t key_of (const Vector3 & point, const Vector3 & normal, uint64_t extra = 0) const
+        {
+            // Las coordenadas de la celda se guardan en 21 bits por eje
+
+            auto cell = [this](float coordinate)
+            {
+                return uint64_t(int64_t(std::floor (coordinate * inverse_cell_size))) & 0x1FFFFF;
+            };
+
+            uint64_t key = mix (cell (point.x) | cell (point.y) << 21 | cell (point.z) << 42);
+
+            return std::max< uint64_t > (mix (key ^ classify_normal (normal) ^ extra), 1);
+        }
+
+        // Celda de la clave. Si no existe se reserva una libre. Devuelve nullptr si no cabe en las
+        // posiciones que se prueban.
+
+        Cell * find (uint64_t key)
+        {
+            for (unsigned probe = 0; probe < maximum_probes; ++probe)
+            {
+                Cell   & cell     = cells[(key + probe) & mask];
+                uint64_t expected = cell.key.load (std::memory_order_relaxed);
+
+                if (expected == key) return &cell;
+
+                if (expected == 0 && cell.key.compare_exchange_strong (expected, key, std::memory_order_relaxed))
+                {
+                    return &cell;
+                }
+
+                if (expected == key) return &cell;          // Otro hilo la ha reservado a la vez
+            }
+
+            return nullptr;
+        }
+
+        // Celda de la clave solo si ya existe
+
+        const Cell * find_existing (uint64_t key) const
+        {
+            for (unsigned probe = 0; probe < maximum_probes; ++probe)
+            {
+                const Cell & cell     = cells[(key + probe) & mask];
+                uint64_t     existing = cell.key.load (std::memory_order_relaxed);
+
+                if (existing == key) return &cell;
+                if (existing == 0  ) return nullptr;
+            }
+
+            return nullptr;
+        }
+
+        // Eje dominante de la normal y su signo (6 orientaciones): eje * 2 + 1 si es negativo
+
+        static uint64_t classify_normal (const Vector3 & normal)
+        {
+            Vector3 magnitude = abs (normal);
+
+            unsigned axis = magnitude.x >= magnitude.y && magnitude.x >= magnitude.z ? 0 : magnitude.y >= magnitude.z ? 1 : 2;
+
+            return axis * 2 + (normal[axis] < 0.f ? 1 : 0);
+        }
+
+    private:
+
+        static uint64_t mix (uint64_t value)
+        {
+            value ^= value >> 30; value *= 0xBF58476D1CE4E5B9ull;
+            value ^= value >> 27; value *= 0x94D049BB133111EBull;
+            value ^= value >> 31;
+
+            return value;
+        }
+
+    };
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <string>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Color.hpp>
+
+namespace udit::raytracer
+{
+
+    // Escritura de imágenes trazadas. Se usa PFM, que guarda los floats rgb tal cual (en color
+    // lineal y sin recortar), para que el revelado se haga después con otras herramientas.
+
+    class Image_File
+    {
+    public:
+
+        static bool write_pfm (const std::string & path, const Buffer< Color > & image);
+
+    };
+
+}
@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <span>
+
+#include <raytracer/Bounding_Box.hpp>
 #include <raytracer/declarations.hpp>
+#include <raytracer/Intersection.hpp>
 #include <raytracer/math.hpp>
+#include <raytracer/Ray.hpp>
 
 namespace udit::raytracer
 {
@@ -21,7 +26,45 @@ namespace udit::raytracer
 
         virtual float   intersect (const Ray & ray, float min_t, float max_t) const = 0;
 
+        // Prueba la primitiva contra un lote de rayos. Si el rayo i la corta entre min_t y
+        // intersections[i].t, actualiza t e intersectable. Las primitivas la redefinen con un
+        // bucle sin llamadas virtuales que el compilador puede vectorizar.
+
+        virtual void intersect (std::span< const Ray > rays, float min_t, std::span< Intersection > intersections) const
+        {
+            for (size_t index = 0; index < rays.size (); ++index)
+            {
+                float t = intersect (rays[index], min_t, intersections[index].t);
+
+                if (t > 0.f)
+                {
+                    intersections[index].t = t;
+                    intersections[index].intersectable = const_cast< Intersectable * >(this);
+                }
+            }
+        }
+
         virtual Vector3 normal_at (const Vector3 & point) const = 0;
+
+        virtual Bounding_Box get_bounding_box () const = 0;
+
+        // Coordenadas de textura de un punto de la superficie y longitud en el espacio de la
+        // escena de una unidad de esas coordenadas (para pasar la huella de un rayo a la textura)
+
+        virtual Vector2 texture_coordinates_at (const Vector3 & ) const
+        {
+            return Vector2(0.f);
+        }
+
+        virtual float get_texture_scale () const
+        {
+            return 1.f;
+        }
+
+        virtual bool is_bounded () const
+        {
+            return true;
+        }
     };
 
 }
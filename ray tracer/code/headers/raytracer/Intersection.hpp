@@ -21,6 +21,7 @@ namespace udit::raytracer
         Intersectable * intersectable;
 
         float   t;
+        float   footprint = 0.f;            // Ancho del cono de rayos en el punto (para las texturas)
     };
 
 }
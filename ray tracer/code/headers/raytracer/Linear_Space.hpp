@@ -7,20 +7,66 @@
 
 #pragma once
 
+#include <future>
+#include <memory>
 #include <vector>
+
+#include <raytracer/Bounding_Box.hpp>
+#include <raytracer/Intersection.hpp>
 #include <raytracer/Scene.hpp>
 #include <raytracer/Spatial_Data_Structure.hpp>
 
 namespace udit::raytracer
 {
 
-    class Linear_Space : public Spatial_Data_Structure
+    class Linear_Space final : public Spatial_Data_Structure
     {
-        using Intersectable_List = std::vector< Intersectable * >;
+        using Intersectable_List  = std::vector< Intersectable * >;
+        using Intersectable_Lists = std::vector< Intersectable_List >;
+
+        // Primitivas acotadas de un modelo junto con la caja que las envuelve, para poder
+        // descartar el modelo entero con una sola prueba
+
+        struct Bounded_Model
+        {
+            Intersectable_List intersectables;
+            Bounding_Box       bounding_box;
+        };
+
+        struct Version
+        {
+            std::vector< Bounded_Model > bounded_models;
+            Intersectable_List         unbounded_intersectables;
+            Bounding_Box               bounding_box;
+            size_t                     bounded_count = 0;
+        };
+
+        using Version_Ptr = std::unique_ptr< Version >;
+
+        // Rayos de un lote que atraviesan una caja, copiados para recorrerlos juntos
+
+        struct Culling_Buffers
+        {
+            std::vector< Ray          > rays;
+            std::vector< Intersection > intersections;
+            std::vector< uint32_t     > lanes;
+        };
+
+        // En los lotes, probar una caja rayo a rayo y compactar cuesta lo que unas pocas
+        // primitivas, así que solo se hace con la de la escena o la de un modelo si dentro hay
+        // bastantes primitivas acotadas.
+
+        static constexpr size_t box_culling_threshold = 8;
+
+        // Con ANY_HIT, los rayos que ya han chocado con algo se apartan del lote cuando son al
+        // menos esta parte de él (apartarlos cuesta recorrer el lote, así que no se hace por uno)
+
+        static constexpr size_t resolved_fraction_divisor = 4;
 
     private:
 
-        Intersectable_List intersectables;
+        Version_Ptr                 current_version;
+        std::future< Version_Ptr >  pending_version;
 
     public:
 
@@ -34,6 +80,65 @@ namespace udit::raytracer
 
         bool traverse (const Ray & ray, float min_t, float max_t, Intersection & intersection) const override;
 
+        Intersectable * occluded (const Ray & ray, float min_t, float max_t) const override;
+
+        void traverse
+        (
+            std::span< const Ray > rays,
+            std::span< Intersection > intersections,
+            unsigned flags,
+            float    min_t,
+            float    max_t
+        ) const override;
+
+        using Spatial_Data_Structure::traverse;
+
+    protected:
+
+        void refit () override;
+
+        void start_rebuild () override;
+
+        bool finish_rebuild () override;
+
+    private:
+
+        Intersectable_Lists gather_intersectables () const;
+
+        static Version_Ptr build_version (Intersectable_Lists models);
+
+        static void compute_bounding_box (Version & version);
+
+        static void intersect_models
+        (
+            const Version           & version,
+            std::span< const Ray >    rays,
+            std::span< Intersection > intersections,
+            unsigned                  flags,
+            float                     min_t
+        );
+
+        static void intersect_list
+        (
+            const Intersectable_List & intersectables,
+            std::span< const Ray >     rays,
+            std::span< Intersection >  intersections,
+            unsigned                   flags,
+            float                      min_t
+        );
+
+        template< class FUNCTION >
+        static void cull_by_box
+        (
+            const Bounding_Box      & bounding_box,
+            std::span< const Ray >    rays,
+            std::span< Intersection > intersections,
+            unsigned                  flags,
+            float                     min_t,
+            Culling_Buffers         & buffers,
+            FUNCTION               && function
+        );
+
     };
 
 }
@@ -9,13 +9,55 @@
 
 #include <raytracer/Color.hpp>
 #include <raytracer/declarations.hpp>
+#include <raytracer/math.hpp>
 
 namespace udit::raytracer
 {
 
     struct Material
     {
-        virtual bool scatter (const Ray & incident_ray, Ray & scattered_ray, const Intersection & intersection, Color & attenuation) = 0;
+        // Identifica la clase concreta del material para poder llamarla sin pasar por la tabla de
+        // funciones virtuales (ver Material_Set). Es nulo en los materiales que no lo indican.
+
+        using Type_Tag = const void *;
+
+        template< class TYPE >
+        static Type_Tag tag_of ()
+        {
+            static const char tag = 0;
+            return &tag;
+        }
+
+        Type_Tag type_tag;
+
+        Material(Type_Tag given_type_tag = nullptr)
+        {
+            type_tag = given_type_tag;
+        }
+
+        // Las decisiones aleatorias se toman con valores del sampler para que se repartan bien entre
+        // las muestras de cada píxel.
+
+        virtual bool scatter (const Ray & incident_ray, Ray & scattered_ray, const Intersection & intersection, Color & attenuation, Sampler & sampler) = 0;
+
+        // Para la estimación directa de la luz: devuelve BSDF * coseno hacia la dirección dada y
+        // la densidad con la que scatter() la habría elegido. Los materiales especulares no pueden
+        // evaluarse para una dirección arbitraria y dejan la densidad a 0.
+
+        virtual Color evaluate (const Ray & , const Intersection & , const Vector3 & , float & pdf) const
+        {
+            pdf = 0.f;
+
+            return Color(0, 0, 0);
+        }
+
+        // La radiancia que sale de una superficie difusa es la misma en todas direcciones, así que
+        // se puede guardar en la caché de radiancia (ver Radiance_Cache).
+
+        virtual bool is_diffuse () const
+        {
+            return false;
+        }
 
         virtual ~Material() = default;
     };
@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <raytracer/Material.hpp>
+
+namespace udit::raytracer
+{
+
+    // Conjunto cerrado de clases de material conocidas al compilar. visit() llama a function con
+    // el material convertido a su clase concreta si es una de MATERIALS, de modo que (siendo las
+    // clases final) sus funciones se llaman directamente y se pueden expandir en línea. Cualquier
+    // otro material se pasa como Material y se llama a través de la tabla virtual.
+
+    template< class ... MATERIALS >
+    struct Material_Set
+    {
+        template< class FUNCTION >
+        static decltype(auto) visit (Material & material, FUNCTION && function)
+        {
+            if constexpr (sizeof...(MATERIALS) == 0)
+            {
+                return function (material);
+            }
+            else
+            {
+                return visit_each< MATERIALS... > (material, function);
+            }
+        }
+
+        static bool scatter (Material & material, const Ray & incident_ray, Ray & scattered_ray, const Intersection & intersection, Color & attenuation, Sampler & sampler)
+        {
+            return visit (material, [&](auto & typed) { return typed.scatter (incident_ray, scattered_ray, intersection, attenuation, sampler); });
+        }
+
+        static Color evaluate (Material & material, const Ray & incident_ray, const Intersection & intersection, const Vector3 & direction, float & pdf)
+        {
+            return visit (material, [&](auto & typed) { return typed.evaluate (incident_ray, intersection, direction, pdf); });
+        }
+
+        static bool is_diffuse (Material & material)
+        {
+            return visit (material, [&](auto & typed) { return typed.is_diffuse (); });
+        }
+
+    private:
+
+        template< class FIRST, class ... REST, class FUNCTION >
+        static decltype(auto) visit_each (Material & material, FUNCTION & function)
+        {
+            if (material.type_tag == Material::tag_of< FIRST > ())
+            {
+                return function (static_cast< FIRST & >(material));
+            }
+
+            if constexpr (sizeof...(REST) == 0)
+            {
+                return function (material);
+            }
+            else
+            {
+                return visit_each< REST... > (material, function);
+            }
+        }
+
+    };
+
+}
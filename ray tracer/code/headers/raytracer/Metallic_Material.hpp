@@ -8,29 +8,43 @@
 #pragma once
 
 #include <raytracer/Color.hpp>
+#include <raytracer/Intersectable.hpp>
 #include <raytracer/Intersection.hpp>
 #include <raytracer/Material.hpp>
 #include <raytracer/math.hpp>
-#include <raytracer/Random.hpp>
 #include <raytracer/Ray.hpp>
+#include <raytracer/Sampler.hpp>
+#include <raytracer/Texture.hpp>
 
 namespace udit::raytracer
 {
 
-    struct Metallic_Material : public Material
+    struct Metallic_Material final : public Material
     {
         static constexpr float epsilon = 0.001f;
 
-        Color albedo;
-        float diffusion;
+        Color           albedo;
+        float           diffusion;
+        const Texture * texture;                // Si no es nulo, multiplica al albedo
 
-        Metallic_Material(Color given_albedo, float given_diffusion)
+        Metallic_Material(Color given_albedo, float given_diffusion, const Texture * given_texture = nullptr) : Material(tag_of< Metallic_Material > ())
         {
             albedo    = given_albedo;
             diffusion = given_diffusion < 1.f ? given_diffusion : 1.f;
+            texture   = given_texture;
         }
 
-        virtual bool scatter (const Ray & incident_ray, Ray & scattered_ray, const Intersection & intersection, Color & attenuation)
+        Color get_albedo (const Intersection & intersection) const
+        {
+            if (not texture) return albedo;
+
+            auto surface = intersection.intersectable;
+            auto uv      = surface->texture_coordinates_at (intersection.point);
+
+            return albedo * texture->sample (uv, intersection.footprint / surface->get_texture_scale ());
+        }
+
+        virtual bool scatter (const Ray & incident_ray, Ray & scattered_ray, const Intersection & intersection, Color & attenuation, Sampler & sampler)
         {
             Vector3  reflected_direction = reflect (normalize (incident_ray.direction), intersection.normal);
 
@@ -42,10 +56,10 @@ namespace udit::raytracer
                 }
                 else
                 {
-                    scattered_ray = Ray{intersection.point, reflected_direction + diffusion * 0.5f * random.point_inside_sphere ()};
+                    scattered_ray = Ray{intersection.point, reflected_direction + diffusion * 0.5f * uniform_point_inside_sphere (sampler.get_2d (), sampler.get_1d ())};
                 }
 
-                attenuation = albedo;
+                attenuation = get_albedo (intersection);
 
                 return true;
             }
@@ -11,6 +11,7 @@
 #include <vector>
 
 #include <raytracer/declarations.hpp>
+#include <raytracer/Generation.hpp>
 #include <raytracer/Node.hpp>
 
 namespace udit::raytracer
@@ -22,9 +23,13 @@ namespace udit::raytracer
 
         Intersectable_List intersectables;
 
+        Generation_Counter * geometry_generation = nullptr;
+
         void add (Intersectable * intersectable)
         {
             intersectables.push_back (intersectable);
+
+            advance (geometry_generation);
         }
     };
 
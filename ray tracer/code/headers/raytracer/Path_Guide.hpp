@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <raytracer/Hashed_Grid.hpp>
+#include <raytracer/math.hpp>
+
+namespace udit::raytracer
+{
+
+    // Guiado de caminos: aprende, mientras se acumulan muestras, de qué direcciones llega la luz a
+    // cada zona de la escena, para que los rebotes difusos se dirijan hacia allí en lugar de elegir
+    // la dirección a ciegas. El espacio se divide en celdas de una rejilla guardadas en una tabla
+    // hash, separadas también por el eje dominante de la normal. Las direcciones de cada celda son
+    // las del hemisferio de ese eje, que se divide en bins proyectándolo sobre un disco (como en el
+    // método de Malley) en rings anillos de igual área por sectors sectores. Cada bin abarca así la
+    // misma parte de la distribución coseno, de modo que sin aprendizaje la distribución es la de un
+    // material difuso y lo aprendido la corrige.
+    // Los caminos terminados suman a cada bin la radiancia que les llegó por esa dirección por el
+    // coseno con la normal, dividida por la densidad con la que se eligió. Entre fotogramas,
+    // update() convierte lo aprendido en la distribución con la que se muestrea en el siguiente,
+    // que así no cambia mientras se traza. El integrador mezcla esta distribución con la del
+    // material (MIS de una muestra), por lo que el resultado no tiene sesgo aunque lo aprendido
+    // sea malo.
+
+    class Path_Guide
+    {
+    public:
+
+        static constexpr unsigned rings                 = 8;
+        static constexpr unsigned sectors               = 8;
+        static constexpr unsigned bins                  = rings * sectors;
+        static constexpr unsigned default_capacity_bits = 14;
+        static constexpr unsigned maximum_probes        = 8;
+        static constexpr uint32_t training_samples      = 1024;    // Muestras que necesita una celda para usarse
+        static constexpr float    uniform_fraction      = .2f;     // Parte uniforme de la distribución, por si lo aprendido no ve alguna dirección
+        static constexpr float    guiding_probability   = .5f;     // Probabilidad de muestrear con el guiado en lugar de con el material
+
+        struct Cell
+        {
+            std::atomic< uint64_t >                   key;                      // 0 si la celda está libre
+            std::atomic< uint32_t >                   sample_count;
+            std::array< std::atomic< float >, bins >  training;
+            std::array< float, bins + 1 >             cdf;                      // Distribución de muestreo
+            bool                                      ready;
+        };
+
+    private:
+
+        Hashed_Grid< Cell, maximum_probes > grid;
+
+    public:
+
+        Path_Guide(float cell_size = .1f, unsigned capacity_bits = default_capacity_bits);
+
+        // Celda del punto para aprender (se crea si no existe). Puede devolver nullptr si la
+        // tabla está llena en esa zona.
+
+        Cell * find (const Vector3 & point, const Vector3 & normal);
+
+        // Celda del punto si ya tiene distribución de muestreo
+
+        const Cell * find_ready (const Vector3 & point, const Vector3 & normal) const;
+
+        void clear ();
+
+        // Recalcula las distribuciones de muestreo con lo aprendido. No debe llamarse mientras se
+        // traza.
+
+        void update ();
+
+    public:
+
+        // normal es la de la superficie con la que se buscó la celda. Las direcciones deben estar
+        // normalizadas.
+
+        static Vector3 sample (const Cell & cell, const Vector3 & normal, const Vector2 & random, float & pdf);
+
+        static float pdf (const Cell & cell, const Vector3 & normal, const Vector3 & direction);
+
+        static void add_sample (Cell & cell, const Vector3 & normal, const Vector3 & direction, float value);
+
+    };
+
+}
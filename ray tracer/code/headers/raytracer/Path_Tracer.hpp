@@ -7,12 +7,26 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <raytracer/Buffer.hpp>
 #include <raytracer/Camera.hpp>
+#include <raytracer/Cancellation_Token.hpp>
 #include <raytracer/Color.hpp>
+#include <raytracer/Intersection.hpp>
+#include <raytracer/Path_Guide.hpp>
+#include <raytracer/Radiance_Cache.hpp>
+#include <raytracer/Ray.hpp>
+#include <raytracer/Ray_Sorter.hpp>
+#include <raytracer/Render_Checkpoint.hpp>
 #include <raytracer/Scene.hpp>
 #include <raytracer/Spatial_Data_Structure.hpp>
 #include <raytracer/Timer.hpp>
@@ -22,6 +36,64 @@ namespace udit::raytracer
 
     class Path_Tracer
     {
+    public:
+
+        // Secuencia de la que cada píxel toma los valores de sus muestras
+
+        enum Sampling_Pattern
+        {
+            WHITE_NOISE,
+            STRATIFIED,
+            SOBOL,
+            BLUE_NOISE,
+        };
+
+        // Parte de los píxeles que se traza en los fotogramas en los que se mueve la cámara: la
+        // mitad en damero o uno de cada bloque de 2x2. El resto se reconstruye (ver
+        // reconstruct_stage()).
+
+        enum Interleaving
+        {
+            NO_INTERLEAVING,
+            CHECKERBOARD,
+            INTERLEAVE_2X2,
+        };
+
+        using Deadline = std::chrono::steady_clock::time_point;
+
+        // Lo que ha trazado una llamada a trace_until(). Cada píxel ha recibido entre
+        // minimum_samples y maximum_samples muestras (se diferencian como mucho en una).
+
+        struct Trace_Report
+        {
+            uint64_t traced_samples   = 0;
+            unsigned minimum_samples  = 0;
+            unsigned maximum_samples  = 0;
+            unsigned completed_passes = 0;      // Veces que se ha llegado al final del viewport
+        };
+
+        // Rectángulo de píxeles del viewport
+
+        struct Tile
+        {
+            unsigned x;
+            unsigned y;
+            unsigned width;
+            unsigned height;
+        };
+
+        // Vista que trace_views() traza junto a otras: el trazador que la acumula (con su cámara)
+        // y lo que se le pediría a trace().
+
+        struct View
+        {
+            Path_Tracer * tracer;
+            unsigned      viewport_width;
+            unsigned      viewport_height;
+            unsigned      number_of_iterations;
+        };
+
+    private:
 
         struct Frame_Data
         {
@@ -29,16 +101,88 @@ namespace udit::raytracer
             const unsigned  viewport_width;
             const unsigned  viewport_height;
             const unsigned  number_of_iterations;
+            const Deadline* deadline       = nullptr;   // Si no es nulo, se traza hasta ese momento
+            Trace_Report    report         = {};
+            bool            camera_changed = false;
+            bool            interleaved    = false;     // Solo se han trazado los píxeles de la fase actual
         };
 
     private:
 
-        static constexpr unsigned recursion_limit = 10;
+        static constexpr unsigned recursion_limit         = 10;
+        static constexpr float    diffuse_cone_spread     = .5f;        // Apertura del cono tras un rebote difuso
+        static constexpr float    checkpoint_flush_period = 2.f;        // Segundos entre volcados a disco
+
+        Buffer< Accumulated_Color > framebuffer;
+        Buffer< Ray               > primary_rays;
+        Buffer< Color             > snapshot;
+
+        Camera * camera;                        // Nula para usar la cámara principal de la escena
+
+        struct
+        {
+            Matrix4 matrix       = Matrix4(0);
+            float   focal_length = 0.f;
+        }
+        tile_camera;                            // Cámara con la que se calcularon los rayos para trace_tile()
 
-        Buffer< Color > framebuffer;
-        Buffer< float > ray_counters;
-        Buffer< Ray   > primary_rays;
-        Buffer< Color > snapshot;
+        struct
+        {
+            Matrix4 matrix       = Matrix4(0);
+            float   focal_length = 0.f;
+            bool    valid        = false;
+        }
+        seen_camera;                            // Cámara del último trazado (puede compartirse con otra vista)
+
+        struct
+        {
+            bool     valid          = false;
+            unsigned width          = 0;
+            unsigned height         = 0;
+            bool     camera_changed = false;
+        }
+        prepared;                               // Etapas del próximo trazado hechas ya por prepare()
+
+        Scene::Generations seen_generations;
+        Generation         seen_space_version;
+        Sampling_Pattern   sampling_pattern;
+        uint32_t           sample_offset;
+        bool               material_sorting;
+        float              pixel_spread;
+
+        const Cancellation_Token * cancellation;                   // Nulo si no se puede cancelar
+        std::atomic< bool >        cancelled;                      // Se ha dejado trabajo sin hacer en el último trazado
+
+        std::unique_ptr< Radiance_Cache > radiance_cache;           // Nulo si no se usa
+        unsigned                          radiance_cache_depth;     // Rebote a partir del cual se consulta
+        std::unique_ptr< Path_Guide     > path_guide;               // Nulo si no se usa
+
+        struct
+        {
+            Render_Checkpoint file;
+            std::string       path;
+            uint64_t          scene_hash = 0;
+            bool              resuming   = false;   // Lo acumulado viene del fichero y aún no se ha visto la cámara
+            Timer             flush_timer;
+        }
+        checkpoint;
+
+        struct
+        {
+            Interleaving    pattern       = NO_INTERLEAVING;
+            unsigned        phase         = 0;          // Píxeles que tocan en el próximo fotograma entrelazado
+            bool            reconstructed = false;      // La imagen del último fotograma está en reconstruction
+            bool            history_valid = false;
+            Buffer< Color > reconstruction;             // Por filas; hace de historia para el siguiente
+        }
+        interleaving;
+
+        struct
+        {
+            unsigned next_group        = 0;     // Grupo de píxeles por el que sigue la próxima llamada
+            float    seconds_per_group = 0.f;   // Tiempo medio de una muestra de un grupo en un hilo
+        }
+        budget;
 
         struct
         {
@@ -53,23 +197,215 @@ namespace udit::raytracer
     public:
 
         Path_Tracer()
+        :
+            // Los píxeles se guardan por baldosas, que son justo los grupos que se trazan juntos
+            framebuffer (Buffer_Layout::TILED),
+            primary_rays(Buffer_Layout::TILED)
         {
-            ray_counters.clear (0.f);
+            camera               = nullptr;
+            seen_space_version   = 0;
+            sampling_pattern     = SOBOL;
+            sample_offset        = 0;
+            material_sorting     = true;
+            pixel_spread         = 0.f;
+            cancellation         = nullptr;
+            cancelled            = false;
+            radiance_cache_depth = 2;
         }
 
-        const Buffer< Color > & get_frame_buffer () const
+        // Cámara de la escena desde la que traza este trazador. Con varios trazadores, cada uno con
+        // su cámara, se trazan varias vistas de la misma escena que comparten la estructura
+        // espacial y solo tienen aparte sus búferes (ver trace_views()). Con nullptr se usa la
+        // cámara principal de la escena.
+
+        void set_camera (Camera * new_camera)
+        {
+            camera = new_camera;
+        }
+
+        Camera * get_camera (Scene & scene) const
+        {
+            return camera ? camera : scene.get_camera ();
+        }
+
+        Sampling_Pattern get_sampling_pattern () const
+        {
+            return sampling_pattern;
+        }
+
+        // Las muestras acumuladas con otra secuencia no se descartan: siguen siendo válidas.
+
+        void set_sampling_pattern (Sampling_Pattern new_sampling_pattern)
+        {
+            sampling_pattern = new_sampling_pattern;
+        }
+
+        // Primera muestra de la secuencia de cada píxel. Los renders que se vayan a juntar después
+        // (ver merge_checkpoint()) deben usar desplazamientos bien separados para no repetir
+        // muestras.
+
+        void set_sample_offset (uint32_t new_sample_offset)
+        {
+            sample_offset = new_sample_offset;
+        }
+
+        // Primera muestra de la secuencia de cada píxel con la que se traza. Después de sumar otra
+        // acumulación (merge_checkpoint()) se salta la parte de la secuencia que esta ya usó.
+
+        uint32_t get_first_sample () const
+        {
+            return sample_offset + (checkpoint.file.is_open () ? checkpoint.file.get_header ().sample_skip : 0);
+        }
+
+        // Mientras se traza, los hilos consultan token antes de cada grupo de píxeles y de cada
+        // muestra, y si se ha pedido la cancelación dejan el resto del trazado para que el siguiente
+        // empiece cuanto antes (por ejemplo, con la cámara en su nueva posición). Lo ya trazado se
+        // queda en la acumulación, pero puede haber píxeles sin ninguna muestra desde que se borró,
+        // así que la instantánea de un trazado cancelado no debe mostrarse. El token lo reinicia
+        // quien lo usa.
+
+        void set_cancellation_token (const Cancellation_Token * token)
+        {
+            cancellation = token;
+        }
+
+        bool was_cancelled () const
+        {
+            return cancelled;
+        }
+
+        // Mientras la cámara se mueve, cada fotograma traza solo una parte de los píxeles, que va
+        // rotando, y rellena el resto con sus vecinos y con el fotograma anterior. Con la cámara
+        // quieta se trazan todos. Solo afecta a trace().
+
+        void set_interleaving (Interleaving new_interleaving)
+        {
+            interleaving.pattern = new_interleaving;
+        }
+
+        Interleaving get_interleaving () const
+        {
+            return interleaving.pattern;
+        }
+
+        // Agrupación por material de las intersecciones antes de sombrear, que solo se hace si lo
+        // medido dice que compensa (ver Ray_Sorter). No cambia el resultado, solo el orden en que
+        // se hace el trabajo.
+
+        void enable_material_sorting (bool enabled)
+        {
+            material_sorting = enabled;
+        }
+
+        // Caché de radiancia para los rebotes difusos (ver Radiance_Cache). Los caminos la
+        // consultan a partir del rebote depth (1 = en el primer punto tras rebotar en la superficie
+        // que se ve). Como cambia el resultado, al activarla o desactivarla se descarta lo
+        // acumulado.
+
+        void enable_radiance_cache (bool enabled, float cell_size = .05f, unsigned depth = 2)
+        {
+            if (enabled != bool(radiance_cache))
+            {
+                radiance_cache = enabled ? std::make_unique< Radiance_Cache > (cell_size) : nullptr;
+
+                framebuffer.clear (Accumulated_Color());
+            }
+            else
+            if (radiance_cache)
+            {
+                radiance_cache->set_cell_size (cell_size);
+                radiance_cache->clear ();
+            }
+
+            radiance_cache_depth = std::max (depth, 1u);
+        }
+
+        bool is_radiance_cache_enabled () const
+        {
+            return bool(radiance_cache);
+        }
+
+        // Guiado de los rebotes difusos con lo aprendido de los caminos ya trazados (ver
+        // Path_Guide). No cambia el valor esperado, así que lo acumulado se conserva.
+
+        void enable_path_guiding (bool enabled, float cell_size = .1f)
+        {
+            path_guide = enabled ? std::make_unique< Path_Guide > (cell_size) : nullptr;
+        }
+
+        bool is_path_guiding_enabled () const
+        {
+            return bool(path_guide);
+        }
+
+        // Guarda la acumulación en el fichero path (ver Render_Checkpoint). Si el fichero ya tiene
+        // una acumulación de la misma escena, viewport y cámara, el render continúa desde ella.
+        // scene_hash identifica el contenido de la escena y lo tiene que dar la aplicación, porque
+        // el trazador no puede saber si la escena que se ha cargado es la misma que la del fichero.
+        // Si el fichero es de otro render no se sobrescribe y no se guarda nada. Tampoco se guarda
+        // después de cambiar el tamaño del viewport, y el fichero conserva lo que tenía; para
+        // seguir guardando hay que volver a llamar a enable_checkpoint() (con otro fichero).
+
+        void enable_checkpoint (const std::string & path, uint64_t scene_hash)
+        {
+            disable_checkpoint ();
+
+            checkpoint.path       = path;
+            checkpoint.scene_hash = scene_hash;
+        }
+
+        void disable_checkpoint ();
+
+        // Puede ser false aunque se haya llamado a enable_checkpoint() si no se pudo abrir el fichero
+
+        bool is_checkpointing () const
+        {
+            return checkpoint.file.is_open ();
+        }
+
+        // Suma la acumulación guardada en otro fichero de checkpoint (ver Render_Checkpoint::merge())
+
+        bool merge_checkpoint (const std::string & path)
+        {
+            return checkpoint.file.is_open () && checkpoint.file.merge (path);
+        }
+
+        const Buffer< Accumulated_Color > & get_frame_buffer () const
         {
             return framebuffer;
         }
 
         const Buffer< Color > & get_snapshot ()
         {
-            for (unsigned i = 0, size = framebuffer.size (); i < size; ++i)
+            copy_snapshot (snapshot);
+
+            return snapshot;
+        }
+
+        // Escribe la imagen acumulada en target, que solo se redimensiona si hace falta. Así se
+        // puede dejar directamente en un búfer ajeno (por ejemplo, el que se va a presentar) sin
+        // copias intermedias. Debe llamarse entre trazados, no mientras se traza.
+
+        void copy_snapshot (Buffer< Color > & target) const
+        {
+            // La instantánea se guarda por filas, que es como se muestra
+
+            target.set_layout (Buffer_Layout::ROW_MAJOR);
+            target.resize_as  (framebuffer);
+
+            if (interleaving.reconstructed)
             {
-                snapshot[i] = framebuffer[i] / ray_counters[i];
+                std::copy (interleaving.reconstruction.data (), interleaving.reconstruction.data () + target.size (), target.data ());
+                return;
             }
 
-            return snapshot;
+            for (unsigned y = 0, height = framebuffer.get_height (); y < height; ++y)
+            {
+                for (unsigned x = 0, width = framebuffer.get_width (); x < width; ++x)
+                {
+                    target.set (x, y, framebuffer.get (x, y).get_average ());
+                }
+            }
         }
 
     public:
@@ -87,72 +423,422 @@ namespace udit::raytracer
             execute_path_tracing_pipeline (frame_data);
         }
 
+        // Traza muestras hasta llegar a deadline, sin esperar a completar el viewport. Va grupo a
+        // grupo de píxeles y la siguiente llamada sigue donde se quedó esta, por lo que con llamadas
+        // sucesivas todos los píxeles reciben muestras por igual. Siempre traza al menos un lote,
+        // aunque deadline ya haya pasado.
+
+        Trace_Report trace_until
+        (
+            Spatial_Data_Structure & space,
+            unsigned viewport_width,
+            unsigned viewport_height,
+            Deadline deadline
+        )
+        {
+            Frame_Data frame_data{ space, viewport_width, viewport_height, 0, &deadline };
+
+            execute_path_tracing_pipeline (frame_data);
+
+            return frame_data.report;
+        }
+
+        // Descarta lo acumulado: el próximo trazado empieza de cero aunque no haya cambiado nada
+
+        void discard_accumulation ()
+        {
+            framebuffer.clear (Accumulated_Color());
+        }
+
+        // Hace por adelantado las etapas de trace() que solo dependen de este trazador y de su
+        // cámara (búferes y rayos primarios), para el próximo trace() con el mismo viewport. Como no
+        // toca la escena, se puede llamar mientras otro Path_Tracer traza la misma escena con otra
+        // cámara, y así solapar la preparación de un fotograma con el trazado del anterior.
+
+        void prepare (Spatial_Data_Structure & space, unsigned viewport_width, unsigned viewport_height)
+        {
+            Frame_Data frame_data{ space, viewport_width, viewport_height, 0 };
+
+            prepare_view (frame_data);
+
+            prepared.valid          = true;
+            prepared.width          = viewport_width;
+            prepared.height         = viewport_height;
+            prepared.camera_changed = frame_data.camera_changed;
+        }
+
+        // Traza a la vez varias vistas de la escena de space (en general con trazadores distintos).
+        // Los grupos de píxeles de todas ellas se reparten juntos entre los hilos, de modo que no
+        // se espera a que termine una vista para empezar la siguiente. Cada vista queda como si se
+        // hubiese llamado a trace() en su trazador.
+
+        static void trace_views (Spatial_Data_Structure & space, std::span< const View > views);
+
+        // Traza number_of_samples muestras por píxel del rectángulo tile, empezando por la muestra
+        // first_sample, sin mezclarlas con lo acumulado por trace(). El resultado se deja por filas
+        // en tile_accumulation. Sirve para repartir un fotograma entre varios procesos, que así
+        // toman muestras distintas de los mismos píxeles (ver Render_Coordinator).
+
+        void trace_tile
+        (
+            Spatial_Data_Structure      & space,
+            unsigned                      viewport_width,
+            unsigned                      viewport_height,
+            const Tile                  & tile,
+            uint32_t                      first_sample,
+            unsigned                      number_of_samples,
+            Buffer< Accumulated_Color > & tile_accumulation
+        );
+
     private:
 
         void execute_path_tracing_pipeline (Frame_Data & frame_data)
+        {
+            begin_frame               (frame_data);
+            sample_primary_rays_stage (frame_data);
+            end_frame                 (frame_data);
+        }
+
+        // Etapas de antes y de después de trazar los caminos, que trace_views() hace vista a vista
+
+        void begin_frame (Frame_Data & frame_data)
         {
             start_benchmark_stage     (frame_data);
+
+            if (prepared.valid and prepared.width == frame_data.viewport_width and prepared.height == frame_data.viewport_height)
+            {
+                frame_data.camera_changed = prepared.camera_changed;
+            }
+            else
+            {
+                prepare_view (frame_data);
+            }
+
+            prepared.valid = false;
+
+            prepare_space_stage       (frame_data);
+        }
+
+        void prepare_view (Frame_Data & frame_data)
+        {
             prepare_buffers_stage     (frame_data);
             check_camera_change_stage (frame_data);
             build_primary_rays_stage  (frame_data);
-            prepare_space_stage       (frame_data);
-            sample_primary_rays_stage (frame_data);
+        }
+
+        void end_frame (Frame_Data & frame_data)
+        {
+            reconstruct_stage         (frame_data);
+            update_guiding_stage      (frame_data);
+            checkpoint_stage          (frame_data);
             end_benchmark_stage       (frame_data);
         }
 
         void start_benchmark_stage (Frame_Data & )
         {
             benchmark.timer.reset ();
+
+            cancelled = false;
         };
 
         void prepare_buffers_stage (Frame_Data & frame_data)
         {
             framebuffer .resize (frame_data.viewport_width, frame_data.viewport_height);
             primary_rays.resize (frame_data.viewport_width, frame_data.viewport_height);
-            ray_counters.resize (frame_data.viewport_width, frame_data.viewport_height);
             snapshot    .resize (frame_data.viewport_width, frame_data.viewport_height);
+
+            // Si resize() ha cambiado el tamaño, el framebuffer ha dejado de usar el fichero. Lo
+            // guardado en él no vale para el nuevo tamaño, pero tampoco se pierde: se deja de
+            // guardar y el fichero se queda como estaba.
+
+            if (checkpoint.file.is_open () and framebuffer.owns_elements ())
+            {
+                close_checkpoint ();
+            }
+
+            if (not checkpoint.path.empty () and not checkpoint.file.is_open ())
+            {
+                open_checkpoint ();
+            }
         }
 
         void check_camera_change_stage (Frame_Data & frame_data)
         {
-            auto camera = frame_data.space.get_scene ().get_camera ();
+            auto   camera = get_camera (frame_data.space.get_scene ());
+            auto & matrix = camera->transform.get_matrix ();
+
+            // Otra vista con la misma cámara puede haber visto ya el aviso del cambio
 
-            if (camera->transform.has_changed (true))
+            bool camera_changed = camera->transform.has_changed (true)
+                               || (seen_camera.valid && (matrix != seen_camera.matrix || camera->get_focal_length () != seen_camera.focal_length));
+
+            seen_camera.matrix       = matrix;
+            seen_camera.focal_length = camera->get_focal_length ();
+            seen_camera.valid        = true;
+
+            // Al continuar un render solo cuenta si la cámara es distinta de la que se guardó
+
+            if (checkpoint.resuming)
             {
-                 framebuffer.clear (Color(0, 0, 0));
-                ray_counters.clear (0.f);
+                camera_changed = not checkpoint.file.matches_camera (camera->transform.get_matrix (), camera->get_focal_length ());
             }
+
+            if (camera_changed)
+            {
+                framebuffer.clear (Accumulated_Color());
+            }
+
+            frame_data.camera_changed = camera_changed;
         }
 
         void build_primary_rays_stage (Frame_Data & frame_data)
         {
-            auto camera = frame_data.space.get_scene ().get_camera ();
+            auto camera = get_camera (frame_data.space.get_scene ());
 
             assert(camera != nullptr);
 
             camera->calculate (primary_rays);
+
+            update_pixel_spread ();
+        }
+
+        // Ángulo entre los rayos primarios de dos píxeles vecinos, que es la apertura inicial del
+        // cono de rayos de cada píxel
+
+        void update_pixel_spread ()
+        {
+            unsigned width  = primary_rays.get_width  ();
+            unsigned height = primary_rays.get_height ();
+
+            if (width < 2) return;
+
+            Vector3 a = normalize (primary_rays.get (width / 2,     height / 2).direction);
+            Vector3 b = normalize (primary_rays.get (width / 2 - 1, height / 2).direction);
+
+            pixel_spread = std::acos (std::min (dot (a, b), 1.f));
         }
 
         void prepare_space_stage (Frame_Data & frame_data)
         {
-            if (not frame_data.space.is_ready ())
+            // La geometría y las transformaciones las gestiona la estructura espacial, que avisa
+            // cuando cambia lo que se ve. Los materiales y el cielo se comprueban aquí.
+
+            auto generations     = frame_data.space.get_scene ().get_generations ();
+            bool shading_changed = generations.materials   != seen_generations.materials
+                                || generations.environment != seen_generations.environment;
+
+            seen_generations = generations;
+
+            // Si otra vista ya ha actualizado la estructura, el cambio se ve en su versión
+
+            frame_data.space.update ();
+
+            bool space_changed = frame_data.space.get_version () != seen_space_version;
+
+            seen_space_version = frame_data.space.get_version ();
+
+            // La primera construcción de la escena al continuar un render no invalida lo guardado
+
+            bool scene_changed = space_changed || shading_changed;
+
+            if (scene_changed && radiance_cache)
+            {
+                radiance_cache->clear ();
+            }
+
+            if (scene_changed && path_guide)
             {
-                frame_data.space.classify_intersectables ();
+                path_guide->clear ();
             }
+
+            if (scene_changed && not checkpoint.resuming)
+            {
+                framebuffer.clear (Accumulated_Color());
+            }
+
+            checkpoint.resuming = false;
         }
 
         void sample_primary_rays_stage (Frame_Data & frame_data);
 
+        void sample_until_deadline (Frame_Data & frame_data);
+
+        template< class SAMPLER, class SCENE >
+        void sample_group
+        (
+            const Frame_Data                & frame_data,
+            typename SCENE::Space           & spatial_data_structure,
+            const typename SCENE::Sky       & sky_environment,
+            unsigned                          group
+        );
+
+        unsigned get_group_count () const
+        {
+            return (primary_rays.size () + wavefront_size - 1) / wavefront_size;
+        }
+
+        bool is_interleaved_pixel (unsigned x, unsigned y) const;
+
+        // Indica si hay que dejar el trazado en curso y en ese caso lo apunta
+
+        bool check_cancellation ()
+        {
+            if (cancellation && cancellation->is_requested ())
+            {
+                cancelled.store (true, std::memory_order_relaxed);
+                return true;
+            }
+
+            return false;
+        }
+
+        void reconstruct_stage (Frame_Data & frame_data);
+
+        template< class FUNCTION >
+        void dispatch_sampler (FUNCTION && function);
+
+        template< class FUNCTION >
+        void dispatch_scene (Spatial_Data_Structure & space, FUNCTION && function);
+
+        template< class SAMPLER, class SCENE >
+        void trace_group
+        (
+            typename SCENE::Space           & spatial_data_structure,
+            const typename SCENE::Sky       & sky_environment,
+            std::span< const unsigned >       pixels,
+            uint32_t                          sample_offset,
+            std::span< Accumulated_Color >    accumulation,
+            unsigned                          number_of_iterations
+        );
+
+        void update_guiding_stage (Frame_Data & )
+        {
+            // Lo aprendido en este fotograma guía los siguientes
+            if (path_guide) path_guide->update ();
+        }
+
+        void checkpoint_stage (Frame_Data & frame_data);
+
         void end_benchmark_stage (Frame_Data & frame_data);
 
+        void open_checkpoint ();
+
+        void close_checkpoint ();
+
     private:
 
-        Color trace_ray
+        // Clases concretas de la escena con las que se especializa el trazado de los caminos. Con
+        // ellas (si son final) el compilador puede llamar directamente y expandir en línea el
+        // recorrido, el cielo y los materiales en vez de pasar por sus tablas virtuales. Las bases
+        // abstractas sirven para cualquier escena (ver dispatch_scene()).
+
+        template< class SPACE, class SKY, class MATERIALS >
+        struct Static_Scene
+        {
+            using Space     = SPACE;
+            using Sky       = SKY;
+            using Materials = MATERIALS;
+        };
+
+        // Camino en curso dentro de un lote. lane es su posición dentro del grupo de píxeles que se
+        // está procesando. scatter_pdf es la densidad con la que el último rebote eligió la
+        // dirección del rayo (0 si no se muestreó también la luz del cielo directamente).
+        // cone_width y cone_spread describen el cono que cubren los rayos del píxel en el origen
+        // del rayo: su ancho y su apertura en radianes (ver Intersection::footprint).
+
+        struct Path
+        {
+            Color    throughput;
+            float    scatter_pdf;
+            unsigned lane;
+            float    cone_width;
+            float    cone_spread;
+        };
+
+        // Búferes de un grupo de píxeles. Los rayos de cada rebote se recorren juntos en un solo
+        // lote, y lo mismo los rayos de sombra hacia el cielo.
+
+        // Primer punto de un camino que no ha podido usar la caché de radiancia. Al terminar el
+        // camino se guarda en su celda la radiancia recogida desde ahí: la que se ha sumado desde
+        // entonces dividida por la atenuación que llevaba el camino al llegar.
+
+        struct Cache_Record
+        {
+            Radiance_Cache::Entry * entry = nullptr;
+            Color                   throughput;
+            Color                   radiance;
+        };
+
+        // Rebote difuso del que se aprende para el guiado: al terminar el camino, la radiancia
+        // que ha llegado por direction es la que se ha sumado después de él dividida por la
+        // atenuación que llevaba el camino al salir en esa dirección. Se aprende la radiancia por
+        // el coseno con la normal (en pdf va dividida por él), que es a lo que conviene que sea
+        // proporcional la distribución de un material difuso.
+
+        struct Guide_Record
+        {
+            Path_Guide::Cell * cell;
+            Vector3            normal;
+            Vector3            direction;
+            float              pdf;
+            Color              throughput;
+            Color              radiance;
+            unsigned           lane;
+        };
+
+        struct Wavefront
+        {
+            std::vector< Path         > paths;
+            std::vector< Ray          > rays;
+            std::vector< Intersection > intersections;
+            std::vector< Path         > next_paths;
+            std::vector< Ray          > next_rays;
+            std::vector< Ray          > shadow_rays;
+            std::vector< Intersection > shadow_intersections;
+            std::vector< Color        > shadow_radiance;
+            std::vector< unsigned     > shadow_lanes;
+            std::vector< Color        > radiance;
+            std::vector< uint32_t     > order;
+            std::vector< Cache_Record > cache_records;
+            std::vector< Guide_Record > guide_records;
+            Ray_Sorter                  sorter;
+        };
+
+        static constexpr unsigned wavefront_size = Buffer_Tiles::area;     // Una baldosa completa
+
+    private:
+
+        template< class SAMPLER, class SCENE >
+        void trace_paths
+        (
+            Wavefront                 & wavefront,
+            typename SCENE::Space     & spatial_data_structure,
+            const typename SCENE::Sky & sky_environment,
+            std::span< SAMPLER >        samplers
+        );
+
+        template< class SAMPLER, class SCENE >
+        bool sample_sky_light
+        (
+            const Ray                 & ray,
+            const Intersection        & intersection,
+            const typename SCENE::Sky & sky_environment,
+            const Path_Guide::Cell    * guide_cell,
+            SAMPLER                   & sampler,
+            Ray                       & shadow_ray,
+            Color                     & radiance
+        );
+
+        template< class SAMPLER, class SCENE >
+        bool scatter_guided
         (
             const Ray              & ray,
-            Spatial_Data_Structure & spatial_data_structure,
-            const Sky_Environment  & sky_environment,
-            unsigned                 depth
+            const Intersection     & intersection,
+            const Path_Guide::Cell & guide_cell,
+            SAMPLER                & sampler,
+            Ray                    & scattered_ray,
+            Color                  & attenuation,
+            float                  & pdf
         );
 
     };
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cmath>
+
 #include <raytracer/Intersectable.hpp>
 #include <raytracer/math.hpp>
 
@@ -29,10 +31,33 @@ namespace udit::raytracer
 
         float intersect (const Ray & ray, float min_t, float max_t) const override;
 
+        void  intersect (std::span< const Ray > rays, float min_t, std::span< Intersection > intersections) const override;
+
         Vector3 normal_at (const Vector3 & ) const override
         {
             return normal;
         }
+
+        Bounding_Box get_bounding_box () const override
+        {
+            return Bounding_Box();
+        }
+
+        bool is_bounded () const override
+        {
+            return false;
+        }
+
+        // Proyección sobre dos ejes del plano: la textura se repite cada unidad de la escena
+
+        Vector2 texture_coordinates_at (const Vector3 & surface_point) const override
+        {
+            Vector3 tangent   = normalize (cross (normal, std::abs (normal.y) < .9f ? Vector3(0, 1, 0) : Vector3(1, 0, 0)));
+            Vector3 bitangent = cross (normal, tangent);
+            Vector3 offset    = surface_point - point;
+
+            return Vector2(dot (offset, tangent), dot (offset, bitangent));
+        }
     };
 
 }
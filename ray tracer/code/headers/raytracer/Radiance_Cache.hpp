@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <raytracer/Color.hpp>
+#include <raytracer/declarations.hpp>
+#include <raytracer/Hashed_Grid.hpp>
+#include <raytracer/math.hpp>
+
+namespace udit::raytracer
+{
+
+    // Caché en el espacio de la escena de la radiancia que sale de las superficies difusas. Es una
+    // tabla hash de celdas de una rejilla, separadas además por la orientación de la normal y por
+    // material. Los caminos que llegan a una celda con suficientes muestras terminan ahí y toman el
+    // valor guardado, en lugar de seguir rebotando. Los que no, siguen y al terminar suman a la
+    // celda la radiancia que han recogido desde ella. Así la caché se llena poco a poco durante los
+    // fotogramas y se vacía cuando cambia la escena.
+    // Introduce sesgo, por lo que no debe usarse en los renders de referencia: la iluminación
+    // indirecta se promedia en cada celda (la imagen queda algo más borrosa) y solo se aprende de
+    // los caminos que terminan antes del límite de rebotes, porque lo que suma el trazador al
+    // cortar un camino depende del rebote y no de la celda. En escenas cerradas, donde casi todos
+    // los caminos llegan al límite, las celdas apenas se entrenan y la caché ahorra poco.
+
+    class Radiance_Cache
+    {
+    public:
+
+        static constexpr unsigned default_capacity_bits = 18;
+        static constexpr unsigned maximum_probes        = 8;        // Posiciones consecutivas que se prueban en la tabla
+        static constexpr uint32_t training_samples      = 16;       // Muestras que necesita una celda para usarse
+        static constexpr uint32_t maximum_samples       = 4096;     // A partir de aquí la celda ya no se refina
+        static constexpr float    refresh_probability   = 1.f / 16; // Parte de las consultas que sigue el camino para refinar
+
+        // Celda de la tabla. key vale 0 si está libre.
+
+        struct Entry
+        {
+            std::atomic< uint64_t > key;
+            std::atomic< float    > red;
+            std::atomic< float    > green;
+            std::atomic< float    > blue;
+            std::atomic< uint32_t > count;
+        };
+
+    private:
+
+        Hashed_Grid< Entry, maximum_probes > grid;
+
+    public:
+
+        Radiance_Cache(float cell_size = .05f, unsigned capacity_bits = default_capacity_bits);
+
+        void set_cell_size (float cell_size)
+        {
+            grid.set_cell_size (cell_size);
+        }
+
+        // Vacía la caché (por ejemplo, porque ha cambiado la escena)
+
+        void clear ();
+
+        // Devuelve la celda del punto o nullptr si no cabe en la tabla
+
+        Entry * find (const Vector3 & point, const Vector3 & normal, const Material * material);
+
+        static bool is_trained (const Entry & entry)
+        {
+            return entry.count.load (std::memory_order_relaxed) >= training_samples;
+        }
+
+        static bool is_saturated (const Entry & entry)
+        {
+            return entry.count.load (std::memory_order_relaxed) >= maximum_samples;
+        }
+
+        static Color get_radiance (const Entry & entry)
+        {
+            float count = float(entry.count.load (std::memory_order_relaxed));
+
+            return Color
+            (
+                entry.red  .load (std::memory_order_relaxed),
+                entry.green.load (std::memory_order_relaxed),
+                entry.blue .load (std::memory_order_relaxed)
+            ) / count;
+        }
+
+        static void add_sample (Entry & entry, const Color & radiance)
+        {
+            entry.red  .fetch_add (radiance.r, std::memory_order_relaxed);
+            entry.green.fetch_add (radiance.g, std::memory_order_relaxed);
+            entry.blue .fetch_add (radiance.b, std::memory_order_relaxed);
+            entry.count.fetch_add (1,          std::memory_order_relaxed);
+        }
+
+    };
+
+}
@@ -63,19 +63,24 @@ namespace udit::raytracer
 
         Vector3 point_inside_sphere ()
         {
-            Vector3 point = point_inside_box_3d ();
+            Vector3 point;
 
-            if (dot (point, point) < 1.f)
+            do
             {
-                return point;
+                point = point_inside_box_3d ();
             }
+            while (dot (point, point) >= 1.f);
 
-            return point * 0.5f;
+            return point;
         }
 
         Vector3 point_on_sphere ()
         {
-            return normalize (point_inside_box_3d ());
+            float z = value_within_11 ();
+            float a = value_within_01 () * 6.28318531f;
+            float r = std::sqrt (1.f - z * z);
+
+            return Vector3{ r * std::cos (a), r * std::sin (a), z };
         }
 
     };
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <raytracer/Random.hpp>
+#include <raytracer/Sampler.hpp>
+
+namespace udit::raytracer
+{
+
+    // Ruido blanco: cada dimensión es independiente. Sirve de referencia para comparar.
+
+    class Random_Sampler final : public Sampler
+    {
+        Random   random;
+        uint32_t seed;
+
+    public:
+
+        Random_Sampler(uint32_t given_seed = 0)
+        {
+            seed = given_seed;
+        }
+
+        void start (unsigned x, unsigned y, uint32_t sample_index) override
+        {
+            random = Random(hash (hash (hash (seed, x), y), sample_index) | 1u);
+        }
+
+        float get_1d () override
+        {
+            return random.value_within_01 ();
+        }
+
+        Vector2 get_2d () override
+        {
+            return Vector2{ random.value_within_01 (), random.value_within_01 () };
+        }
+    };
+
+}
@@ -12,10 +12,24 @@
 namespace udit::raytracer
 {
 
+    // La inversa de la dirección se calcula al crear el rayo porque la usan los tests contra cajas
+    // envolventes, que se repiten para cada modelo de la escena (ver Bounding_Box::intersects()).
+
     struct Ray
     {
         Vector3 origin;
         Vector3 direction;
+        Vector3 inverse_direction;
+
+        Ray() = default;
+
+        Ray(const Vector3 & given_origin, const Vector3 & given_direction)
+        :
+            origin           (given_origin),
+            direction        (given_direction),
+            inverse_direction(1.f / given_direction)
+        {
+        }
 
         Vector3 point_at (float t) const
         {
@@ -0,0 +1,80 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <raytracer/declarations.hpp>
+
+namespace udit::raytracer
+{
+
+    // Agrupa por material las intersecciones de un lote antes de sombrearlas, para que cada
+    // material reutilice su código y sus datos. Ordenar tiene un coste y lo que se gana depende
+    // de la escena (con materiales sencillos no se gana nada), así que el propio sorter mide lo
+    // que cuesta sombrear cada rayo con y sin agrupar y solo agrupa si sale más barato, probando
+    // de vez en cuando la otra opción por si ha cambiado.
+    // Cada hilo debe tener el suyo.
+
+    class Ray_Sorter
+    {
+    public:
+
+        static constexpr size_t   minimum_batch_size = 128;     // Por debajo, ordenar cuesta más de lo que se gana
+        static constexpr unsigned trial_period       = 32;      // Cada cuántos lotes se prueba la opción que parece peor
+        static constexpr double   cost_decay         = .95;     // Peso de las medidas anteriores frente a la última
+
+    private:
+
+        struct Entry
+        {
+            uint64_t primary_key;
+            uint64_t secondary_key;
+            uint32_t index;
+        };
+
+        struct Shading_Cost
+        {
+            double seconds = 0.0;
+            double rays    = 0.0;
+        };
+
+        std::vector< Entry > entries;
+        Shading_Cost         costs[2];                          // Sin agrupar y agrupando
+        unsigned             batch_count = 0;
+
+    public:
+
+        static bool pays_off (size_t batch_size)
+        {
+            return batch_size >= minimum_batch_size;
+        }
+
+        // Decide si se agrupa el próximo lote de batch_size intersecciones según lo medido
+
+        bool wants_material_sorting (size_t batch_size);
+
+        // Tiempo que ha costado sombrear un lote (incluida la agrupación si se hizo)
+
+        void record_shading (bool sorted, size_t batch_size, float seconds);
+
+        // Deja en order los índices de las intersecciones agrupados por tipo de material y
+        // material (los rayos que no chocan con nada van primero) y devuelve true, salvo que todas
+        // tengan el mismo.
+
+        bool sort_by_material (std::span< const Intersection > intersections, std::vector< uint32_t > & order);
+
+    private:
+
+        bool sort_entries (std::vector< uint32_t > & order);
+
+    };
+
+}
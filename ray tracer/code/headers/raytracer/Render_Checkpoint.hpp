@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Color.hpp>
+#include <raytracer/math.hpp>
+
+namespace udit::raytracer
+{
+
+    // Fichero proyectado en memoria que guarda la acumulación de un render progresivo. Tras una
+    // cabecera van los píxeles tal como están en el framebuffer, que trabaja directamente sobre
+    // ellos (ver Buffer::attach()), de modo que guardar no cuesta ninguna copia: el sistema escribe
+    // en disco las páginas modificadas en segundo plano y flush() solo le pide que empiece ya. Si el
+    // proceso termina, lo acumulado sigue en el fichero y un render posterior con la misma escena y
+    // cámara puede continuar desde ahí.
+    // Solo está implementado con POSIX (Linux y macOS). En otras plataformas open() falla y el
+    // render sigue sin respaldo.
+
+    class Render_Checkpoint
+    {
+    public:
+
+        static constexpr uint32_t version     = 2;
+        static constexpr size_t   data_offset = 4096;      // Los píxeles empiezan en una página nueva
+
+        struct Header
+        {
+            char     magic[8];
+            uint32_t version;
+            uint32_t element_size;
+            uint32_t width;
+            uint32_t height;
+            uint32_t layout;
+            uint32_t sample_offset;                 // Primera muestra de la secuencia de cada píxel
+            uint32_t sample_skip;                   // Muestras que se saltan tras sumar otras (merge())
+            uint64_t scene_hash;                    // Identifica la escena (lo da la aplicación)
+            uint64_t total_samples;                 // Suma de las muestras de todos los píxeles
+            float    camera_matrix[16];
+            float    focal_length;
+        };
+
+        static_assert(sizeof(Header) <= data_offset);
+
+    private:
+
+        int    file;
+        void * mapping;
+        size_t mapping_size;
+
+    public:
+
+        Render_Checkpoint() : file(-1), mapping(nullptr), mapping_size(0)
+        {
+        }
+
+        Render_Checkpoint(const Render_Checkpoint & ) = delete;
+        Render_Checkpoint & operator = (const Render_Checkpoint & ) = delete;
+
+       ~Render_Checkpoint()
+        {
+            close ();
+        }
+
+    public:
+
+        bool is_open () const
+        {
+            return mapping != nullptr;
+        }
+
+        Header & get_header ()
+        {
+            return *static_cast< Header * >(mapping);
+        }
+
+        const Header & get_header () const
+        {
+            return *static_cast< const Header * >(mapping);
+        }
+
+        Accumulated_Color * get_pixels ()
+        {
+            return reinterpret_cast< Accumulated_Color * >(static_cast< std::byte * >(mapping) + data_offset);
+        }
+
+        bool matches_camera (const Matrix4 & matrix, float focal_length) const;
+
+        void set_camera (const Matrix4 & matrix, float focal_length);
+
+    public:
+
+        // Abre o crea el fichero para un framebuffer del tamaño y organización dados. Si ya tenía
+        // una acumulación compatible (misma escena, tamaño y organización) la conserva y devuelve
+        // true. Si el fichero es nuevo (o está vacío), lo deja a cero con una cabecera nueva y
+        // devuelve false. Un fichero con otro contenido no se toca y open() falla, para no perder
+        // la acumulación de otro render. Hay que comprobar is_open() para saber si ha fallado.
+
+        bool open
+        (
+            const std::string & path,
+            unsigned            width,
+            unsigned            height,
+            Buffer_Layout       layout,
+            uint64_t            scene_hash,
+            uint32_t            sample_offset
+        );
+
+        // Suma a este fichero las muestras guardadas en otro, que debe ser de la misma escena,
+        // tamaño y cámara y haberse trazado con otro sample_offset (si no, repetiría las mismas
+        // muestras). Así se pueden juntar renders parciales hechos por separado.
+        // El número de muestras de cada píxel pasa a incluir las del otro, pero la secuencia sigue
+        // siendo la de este fichero. Para que al continuar no se repitan muestras de ninguno de los
+        // dos, sample_skip se ajusta de modo que sample_offset + sample_skip sea el mayor de los
+        // comienzos de ambos: la siguiente muestra de cada píxel queda así detrás de las que ya
+        // usaron los dos. El fichero se puede seguir continuando como antes.
+
+        bool merge (const std::string & other_path);
+
+        // Pide al sistema que empiece a escribir en disco lo modificado, sin esperar a que termine
+
+        void flush ();
+
+        void close ();
+
+    };
+
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Color.hpp>
+#include <raytracer/declarations.hpp>
+#include <raytracer/Render_Protocol.hpp>
+#include <raytracer/Socket.hpp>
+#include <raytracer/Timer.hpp>
+
+namespace udit::raytracer
+{
+
+    // Reparte el trazado de un fotograma entre procesos Render_Worker, que pueden estar en la misma
+    // máquina (direcciones "unix:...") o en otras ("tcp:..."). El fotograma se divide en trabajos
+    // (una baldosa y un rango de muestras) que se reparten entre las colas de los trabajadores. Un
+    // trabajador que vacía su cola roba la mitad de la más larga, y si ya no queda nada por
+    // repartir duplica el trabajo pendiente más antiguo de otro por si este va lento: gana el
+    // primer resultado que llega. Los trabajos de un trabajador que se desconecta se reparten de
+    // nuevo.
+
+    class Render_Coordinator
+    {
+    public:
+
+        static constexpr unsigned jobs_in_flight = 2;       // Trabajos enviados a la vez a cada trabajador
+
+    private:
+
+        struct Job
+        {
+            Render_Job description;
+            bool       completed;
+            unsigned   copies;                              // Trabajadores a los que se ha enviado
+            Timer      dispatch_timer;
+        };
+
+        struct Dispatched_Job
+        {
+            uint32_t frame;
+            uint32_t job;
+            uint32_t pixel_count;                           // Los que tiene que traer su resultado
+        };
+
+        struct Worker
+        {
+            Socket                        connection;
+            std::thread                   thread;
+            std::deque < uint32_t       > queue;
+            std::vector< Dispatched_Job > in_flight;
+            bool                          alive = true;
+        };
+
+    private:
+
+        Socket                                   listener;
+        std::vector< std::unique_ptr< Worker > > workers;
+
+        unsigned                      tile_size;
+        unsigned                      samples_per_job;
+
+        std::mutex                    mutex;
+        std::condition_variable       work_available;
+        std::condition_variable       frame_completed;
+
+        bool                          running;
+        uint32_t                      frame;
+        std::vector< Job >            jobs;
+        size_t                        remaining_jobs;
+        Buffer< Accumulated_Color > * accumulation;
+
+    public:
+
+        Render_Coordinator(unsigned given_tile_size = 64, unsigned given_samples_per_job = 4)
+        {
+            tile_size       = given_tile_size;
+            samples_per_job = std::clamp (given_samples_per_job, 1u, Render_Limits::max_samples_per_pixel);
+            running         = true;
+            frame           = 0;
+            remaining_jobs  = 0;
+            accumulation    = nullptr;
+        }
+
+       ~Render_Coordinator();
+
+    public:
+
+        bool listen (const std::string & address)
+        {
+            listener = Socket::listen (address);
+
+            return listener.is_open ();
+        }
+
+        // Espera a que se conecten count trabajadores. Devuelve cuántos hay conectados en total.
+
+        unsigned accept_workers (unsigned count);
+
+        unsigned get_worker_count ();
+
+        // Traza samples_per_pixel muestras de cada píxel, empezando por first_sample, y las suma
+        // a given_accumulation (que se redimensiona al viewport si hace falta). La escena de los
+        // trabajadores se sitúa con la cámara dada. Devuelve false si no queda ningún trabajador
+        // o el viewport no cabe en Render_Limits.
+
+        bool render
+        (
+            Camera                      & camera,
+            unsigned                      viewport_width,
+            unsigned                      viewport_height,
+            uint32_t                      first_sample,
+            unsigned                      samples_per_pixel,
+            Buffer< Accumulated_Color > & given_accumulation
+        );
+
+    private:
+
+        void serve (Worker & worker);
+
+        bool next_job (Worker & worker, uint32_t & job);
+
+        void merge (const Render_Job & job, const Accumulated_Color * pixels);
+
+        void abandon (Worker & worker);
+
+        Worker * find_shortest_queue ();
+
+    };
+
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace udit::raytracer
+{
+
+    // Mensajes que intercambian Render_Coordinator y Render_Worker, y los clientes de un
+    // Render_Server con él. Se envían tal cual están en memoria, por lo que todos los procesos deben ejecutarse en máquinas con la misma
+    // representación de los números (en la práctica, little endian y float IEEE 754).
+    // Cada mensaje empieza con una cabecera que indica su tipo y el tamaño de lo que sigue.
+
+    struct Render_Message
+    {
+        enum Type : uint32_t
+        {
+            JOB    = 1,
+            RESULT = 2,
+            STOP   = 3,
+            SUBMIT = 4,         // Cliente -> Render_Server: Render_Server_Job
+            QUERY  = 5,         // Cliente -> Render_Server: identificador del trabajo (uint32_t)
+            STATUS = 6,         // Render_Server -> cliente: Render_Job_Status
+        };
+
+        uint32_t type;
+        uint32_t size;
+    };
+
+    // Estado de la cámara de la escena: el trabajador lo aplica a su propia copia de la escena.
+
+    struct Render_Camera_State
+    {
+        float position    [3];
+        float rotation    [3];
+        float scales      [3];
+        float focal_length;
+    };
+
+    // Trabajo: number_of_samples muestras, empezando por first_sample, de un rectángulo de píxeles.
+
+    struct Render_Job
+    {
+        uint32_t frame;
+        uint32_t job;
+        uint32_t viewport_width;
+        uint32_t viewport_height;
+        uint32_t tile_x;
+        uint32_t tile_y;
+        uint32_t tile_width;
+        uint32_t tile_height;
+        uint32_t first_sample;
+        uint32_t number_of_samples;
+
+        Render_Camera_State camera;
+    };
+
+    // Resultado: va seguido de tile_width * tile_height píxeles por filas, cada uno con la suma
+    // de sus muestras en rgb y su número en w (4 floats).
+
+    struct Render_Result
+    {
+        uint32_t frame;
+        uint32_t job;
+        uint32_t pixel_count;
+    };
+
+    // Trabajo para Render_Server: samples_per_pixel muestras por píxel de la escena vista desde
+    // camera, guardadas en output_path (terminada en '\0'). Se atienden antes los de mayor
+    // prioridad y, a igual prioridad, por orden de llegada.
+
+    struct Render_Server_Job
+    {
+        uint32_t            priority;
+        uint32_t            viewport_width;
+        uint32_t            viewport_height;
+        uint32_t            samples_per_pixel;
+        Render_Camera_State camera;
+        char                output_path[256];
+    };
+
+    // Respuesta de Render_Server a SUBMIT (con el identificador asignado) y a QUERY
+
+    struct Render_Job_Status
+    {
+        enum State : uint32_t
+        {
+            UNKNOWN   = 0,
+            QUEUED    = 1,
+            RUNNING   = 2,
+            COMPLETED = 3,
+            FAILED    = 4,              // No se ha podido escribir la imagen o el trabajo no es válido
+        };
+
+        uint32_t id;
+        uint32_t state;
+        uint32_t queued_jobs;           // Trabajos en cola en el servidor
+    };
+
+    // Límites de lo que se acepta de la red, para que un mensaje mal formado no pueda pedir una
+    // reserva enorme ni desbordar los cálculos de tamaños (8192 x 8192 píxeles caben en 32 bits)
+
+    struct Render_Limits
+    {
+        static constexpr uint32_t max_viewport_size     = 8192;      // Píxeles de ancho o de alto
+        static constexpr uint32_t max_samples_per_pixel = 65536;
+
+        static bool is_valid_viewport (uint32_t width, uint32_t height)
+        {
+            return width > 0 && height > 0 && width <= max_viewport_size && height <= max_viewport_size;
+        }
+
+        static bool is_valid_sample_count (uint32_t samples)
+        {
+            return samples > 0 && samples <= max_samples_per_pixel;
+        }
+    };
+
+    static_assert(std::is_trivially_copyable_v< Render_Job        >);
+    static_assert(std::is_trivially_copyable_v< Render_Result     >);
+    static_assert(std::is_trivially_copyable_v< Render_Server_Job >);
+    static_assert(std::is_trivially_copyable_v< Render_Job_Status >);
+
+}
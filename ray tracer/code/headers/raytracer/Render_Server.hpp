@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Color.hpp>
+#include <raytracer/Path_Tracer.hpp>
+#include <raytracer/Render_Protocol.hpp>
+#include <raytracer/Socket.hpp>
+
+namespace udit::raytracer
+{
+
+    // Proceso que traza imágenes por encargo sin tener que arrancar una aplicación para cada una.
+    // La escena (construida por la aplicación) y su estructura espacial se preparan una vez y se
+    // reutilizan en todos los trabajos. Los clientes se conectan (normalmente con "unix:...") y
+    // envían trabajos (SUBMIT), que esperan en una cola por prioridad y se trazan uno tras otro con
+    // todos los hilos, o preguntan cómo va uno (QUERY). Cada imagen se guarda en formato PFM
+    // (ver Image_File). Un mensaje STOP termina el servidor al acabar el trabajo en curso.
+    // El programa render-node (en "render node") lo aloja con una escena de ejemplo.
+
+    class Render_Server
+    {
+        struct Job
+        {
+            uint32_t          id;
+            Render_Server_Job description;
+        };
+
+        // Los de mayor prioridad primero y, a igual prioridad, el más antiguo
+
+        struct Job_Order
+        {
+            bool operator () (const Job & a, const Job & b) const
+            {
+                return a.description.priority != b.description.priority
+                     ? a.description.priority <  b.description.priority
+                     : a.id > b.id;
+            }
+        };
+
+        struct Client
+        {
+            Socket      connection;
+            std::thread thread;
+            bool        finished = false;       // serve() ha terminado y ha cerrado la conexión
+        };
+
+        // Estados de trabajos terminados que se recuerdan para las consultas. Los más antiguos se
+        // olvidan (y se consultan como UNKNOWN) para que el servidor pueda atender indefinidamente.
+
+        static constexpr size_t max_finished_states = 1024;
+
+    private:
+
+        Spatial_Data_Structure      & space;
+        Path_Tracer                   path_tracer;
+        Buffer< Accumulated_Color >   accumulation;
+        Buffer< Color             >   image;
+        Socket                        listener;
+        std::thread                   acceptor;
+
+        std::mutex                                             mutex;
+        std::condition_variable                                job_available;
+        std::priority_queue< Job, std::vector< Job >, Job_Order > queue;
+        std::unordered_map< uint32_t, Render_Job_Status::State > states;
+        std::deque< uint32_t >                                 finished_jobs;
+        std::vector< std::unique_ptr< Client > >               clients;
+        uint32_t                                               next_id;
+        bool                                                   running;
+
+    public:
+
+        Render_Server(Spatial_Data_Structure & given_space) : space(given_space)
+        {
+            next_id = 1;
+            running = true;
+        }
+
+       ~Render_Server();
+
+        Render_Server(const Render_Server & ) = delete;
+        Render_Server & operator = (const Render_Server & ) = delete;
+
+    public:
+
+        Path_Tracer & get_path_tracer ()
+        {
+            return path_tracer;
+        }
+
+        bool listen (const std::string & address)
+        {
+            listener = Socket::listen (address);
+
+            return listener.is_open ();
+        }
+
+        // Atiende a los clientes y traza sus trabajos en este hilo hasta que se llama a stop() o
+        // llega un STOP. Devuelve el número de trabajos completados.
+
+        unsigned run ();
+
+        // Se puede llamar desde cualquier hilo. El trabajo en curso se termina.
+
+        void stop ();
+
+    private:
+
+        void accept_clients ();
+
+        void remove_finished_clients ();
+
+        void serve (Client & client);
+
+        Render_Job_Status submit (const Render_Server_Job & description);
+
+        Render_Job_Status get_status (uint32_t id);
+
+        void finish_job (uint32_t id, bool completed);
+
+        bool execute (const Render_Server_Job & description);
+
+    };
+
+}
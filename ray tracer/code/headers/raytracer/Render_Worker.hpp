@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <string>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Color.hpp>
+#include <raytracer/Path_Tracer.hpp>
+#include <raytracer/Render_Protocol.hpp>
+#include <raytracer/Socket.hpp>
+
+namespace udit::raytracer
+{
+
+    // Proceso que traza trabajos para un Render_Coordinator. Tiene su propia copia de la escena
+    // (construida por la aplicación igual que la del coordinador) y su propio Path_Tracer. Cada
+    // trabajo trae el estado de la cámara, que se aplica a la escena antes de trazarlo.
+
+    class Render_Worker
+    {
+        Spatial_Data_Structure    & space;
+        Path_Tracer                 path_tracer;
+        Buffer< Accumulated_Color > tile_accumulation;
+        Socket                      connection;
+
+    public:
+
+        Render_Worker(Spatial_Data_Structure & given_space) : space(given_space)
+        {
+        }
+
+        Path_Tracer & get_path_tracer ()
+        {
+            return path_tracer;
+        }
+
+        bool connect (const std::string & address)
+        {
+            connection = Socket::connect (address);
+
+            return connection.is_open ();
+        }
+
+        // Atiende trabajos hasta que el coordinador lo detiene o se pierde la conexión. Devuelve
+        // el número de trabajos completados.
+
+        unsigned run ();
+
+    private:
+
+        static bool is_valid (const Render_Job & job);
+
+        bool execute (const Render_Job & job);
+
+    };
+
+}
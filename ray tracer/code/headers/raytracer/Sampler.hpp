@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+#include <raytracer/math.hpp>
+
+namespace udit::raytracer
+{
+
+    // Fuente de los valores aleatorios que consume el integrador. Cada muestra de cada píxel es un
+    // punto de un espacio de muchas dimensiones: cada decisión (dirección de rebote, muestreo de la
+    // luz...) consume la siguiente dimensión, lo que permite a las implementaciones repartir bien
+    // los puntos en cada una de ellas y no solo en conjunto.
+
+    class Sampler
+    {
+    public:
+
+        virtual ~Sampler() = default;
+
+        // Empieza la muestra sample_index del píxel (x, y) volviendo a la primera dimensión.
+
+        virtual void start (unsigned x, unsigned y, uint32_t sample_index) = 0;
+
+        // Valores en [0, 1). get_2d() devuelve un par de dimensiones que se reparten bien juntas.
+
+        virtual float   get_1d () = 0;
+        virtual Vector2 get_2d () = 0;
+
+    public:
+
+        static uint32_t hash (uint32_t value)
+        {
+            value ^= value >> 16; value *= 0x7FEB352Du;
+            value ^= value >> 15; value *= 0x846CA68Bu;
+            value ^= value >> 16;
+
+            return value;
+        }
+
+        static uint32_t hash (uint32_t a, uint32_t b)
+        {
+            return hash (a ^ (hash (b) + 0x9E3779B9u + (a << 6) + (a >> 2)));
+        }
+
+        static float to_float (uint32_t bits)
+        {
+            return float(bits >> 8) * 0x1p-24f;
+        }
+    };
+
+    // CONVERSIONES DE MUESTRAS EN [0, 1) A DIRECCIONES Y PUNTOS:
+
+    // Base ortonormal a partir de un vector normalizado (Duff et al. 2017).
+
+    inline void build_orthonormal_basis (const Vector3 & normal, Vector3 & tangent, Vector3 & bitangent)
+    {
+        float sign = std::copysign (1.f, normal.z);
+        float a    = -1.f / (sign + normal.z);
+        float b    = normal.x * normal.y * a;
+
+        tangent   = Vector3(1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+        bitangent = Vector3(b, sign + normal.y * normal.y * a, -normal.y);
+    }
+
+    // Dirección del hemisferio de la normal con densidad coseno / pi (método de Malley).
+
+    inline Vector3 cosine_weighted_direction (const Vector3 & normal, const Vector2 & sample)
+    {
+        Vector3 tangent, bitangent;
+
+        build_orthonormal_basis (normal, tangent, bitangent);
+
+        float radius = std::sqrt (sample.x);
+        float angle  = 2.f * std::numbers::pi_v< float > * sample.y;
+        float x      = radius * std::cos (angle);
+        float y      = radius * std::sin (angle);
+        float z      = std::sqrt (std::max (0.f, 1.f - sample.x));
+
+        return tangent * x + bitangent * y + normal * z;
+    }
+
+    inline Vector3 uniform_point_on_sphere (const Vector2 & sample)
+    {
+        float z      = 1.f - 2.f * sample.x;
+        float radius = std::sqrt (std::max (0.f, 1.f - z * z));
+        float angle  = 2.f * std::numbers::pi_v< float > * sample.y;
+
+        return Vector3(radius * std::cos (angle), radius * std::sin (angle), z);
+    }
+
+    inline Vector3 uniform_point_inside_sphere (const Vector2 & sample, float radial_sample)
+    {
+        return uniform_point_on_sphere (sample) * std::cbrt (radial_sample);
+    }
+
+}
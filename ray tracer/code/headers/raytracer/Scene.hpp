@@ -11,8 +11,11 @@
 #include <type_traits>
 #include <vector>
 
+#include <raytracer/Arena_Family.hpp>
 #include <raytracer/declarations.hpp>
-#include <raytracer/Memory_Pool.hpp>
+#include <raytracer/Generation.hpp>
+#include <raytracer/Texture.hpp>
+#include <raytracer/Texture_Cache.hpp>
 
 namespace udit::raytracer
 {
@@ -20,11 +23,12 @@ namespace udit::raytracer
     class Scene
     {
         using Camera_Ptr          = std::unique_ptr< Camera          >;
-        using Material_Ptr        = std::unique_ptr< Material        >;
-        using Material_List       = std::vector    < Material_Ptr    >;
+        using Camera_List         = std::vector    < Camera_Ptr      >;
         using Model_Ptr           = std::unique_ptr< Model           >;
         using Model_List          = std::vector    < Model_Ptr       >;
         using Sky_Environment_Ptr = std::unique_ptr< Sky_Environment >;
+        using Texture_Ptr         = std::unique_ptr< Texture         >;
+        using Texture_List        = std::vector    < Texture_Ptr     >;
 
     public:
 
@@ -63,26 +67,86 @@ namespace udit::raytracer
         using       Iterator = Iterator_Template< Model_List::      iterator >;
         using Const_Iterator = Iterator_Template< Model_List::const_iterator >;
 
+        // Instantánea de los contadores de generación. Quien dependa de la escena guarda la última
+        // que ha visto y la compara con la actual para saber qué ha cambiado desde entonces.
+
+        struct Generations
+        {
+            Generation geometry    = 0;               // Modelos y primitivas añadidos
+            Generation materials   = 0;
+            Generation transforms  = 0;               // Transformaciones de los modelos
+            Generation environment = 0;               // Cielo
+
+            bool operator == (const Generations & ) const = default;
+        };
+
     private:
 
-        Camera_Ptr          camera;
-        Memory_Pool         intersectable_pool;
-        Material_List       materials;
+        Camera_List         cameras;
+        Camera            * main_camera = nullptr;
+        Arena_Family        arenas;                 // Primitivas y materiales (se pueden crear en paralelo)
         Model_List          models;
         Sky_Environment_Ptr sky_environment;
+        Texture_Cache       texture_cache;          // La comparten todas las texturas
+        Texture_List        textures;
+
+        Generation_Counter  geometry_generation    { 0 };
+        Generation_Counter  materials_generation   { 0 };
+        Generation_Counter  transforms_generation  { 0 };
+        Generation_Counter  environment_generation { 0 };
 
-        unsigned hash;                              // Permitiría saber si se han añadido y/o quitado elementos
-                                                    // Podría hacerse sumando un ID autonumérico al añadir y restándolo al quitar
     public:
 
+        Generations get_generations () const
+        {
+            return
+            {
+                geometry_generation   .load (std::memory_order_relaxed),
+                materials_generation  .load (std::memory_order_relaxed),
+                transforms_generation .load (std::memory_order_relaxed),
+                environment_generation.load (std::memory_order_relaxed),
+            };
+        }
+
+        // Para cambios hechos directamente sobre los objetos, que la escena no puede ver (p. ej. al
+        // modificar el albedo de un material o al mover el centro de una esfera):
+
+        void touch_geometry    () { advance (&   geometry_generation); }
+        void touch_materials   () { advance (&  materials_generation); }
+        void touch_transforms  () { advance (& transforms_generation); }
+        void touch_environment () { advance (&environment_generation); }
+
+    public:
+
+        // La cámara principal es la primera que se crea, salvo que se elija otra con
+        // set_main_camera(). Las demás sirven para trazar otras vistas de la misma escena (ver
+        // Path_Tracer::set_camera()).
+
         Camera * get_camera ()
         {
-            return camera.get ();
+            return main_camera;
         }
 
         const Camera * get_camera () const
         {
-            return camera.get ();
+            return main_camera;
+        }
+
+        // camera tiene que ser una cámara creada en esta escena
+
+        void set_main_camera (Camera * camera)
+        {
+            main_camera = camera;
+        }
+
+        unsigned get_camera_count () const
+        {
+            return unsigned(cameras.size ());
+        }
+
+        Camera * get_camera (unsigned index)
+        {
+            return cameras[index].get ();
         }
 
         Sky_Environment * get_sky_environment ()
@@ -95,6 +159,16 @@ namespace udit::raytracer
             return sky_environment.get ();
         }
 
+        Texture_Cache & get_texture_cache ()
+        {
+            return texture_cache;
+        }
+
+        Arena_Statistics get_memory_statistics ()
+        {
+            return arenas.get_statistics ();
+        }
+
         Iterator begin ()
         {
             return models.begin ();
@@ -128,36 +202,56 @@ namespace udit::raytracer
     {
         if constexpr (std::is_base_of< Camera, CLASS >::value)
         {
-            camera = std::make_unique< CLASS > (arguments...);
+            cameras.push_back (std::make_unique< CLASS > (arguments...));
 
-            return static_cast< CLASS * >(camera.get ());
+            if (main_camera == nullptr) main_camera = cameras.back ().get ();
+
+            return static_cast< CLASS * >(cameras.back ().get ());
         }
         else
         if constexpr (std::is_base_of< Intersectable, CLASS >::value)
         {
-            return intersectable_pool.allocate< CLASS > (arguments...);
+            advance (&geometry_generation);
+
+            return arenas.create< CLASS > (arguments...);
         }
         else
         if constexpr (std::is_base_of< Material, CLASS >::value)
         {
-            materials.emplace_back (std::make_unique< CLASS > (arguments...));
+            advance (&materials_generation);
 
-            return static_cast< CLASS * >(materials.back ().get ());
+            return arenas.create< CLASS > (arguments...);
         }
         else
         if constexpr (std::is_base_of< Model, CLASS >::value)
         {
             models.emplace_back (std::make_unique< CLASS > (arguments...));
 
-            return static_cast< CLASS * >(models.back ().get ());
+            auto model = static_cast< CLASS * >(models.back ().get ());
+
+            model->geometry_generation = &geometry_generation;
+            model->transform.track (transforms_generation);
+
+            advance (&geometry_generation);
+
+            return model;
         }
         else
         if constexpr (std::is_base_of< Sky_Environment, CLASS >::value)
         {
             sky_environment = std::make_unique< CLASS > (arguments...);
 
+            advance (&environment_generation);
+
             return static_cast< CLASS * >(sky_environment.get ());
         }
+        else
+        if constexpr (std::is_base_of< Texture, CLASS >::value)
+        {
+            textures.emplace_back (std::make_unique< CLASS > (texture_cache, arguments...));
+
+            return static_cast< CLASS * >(textures.back ().get ());
+        }
     }
 
 }
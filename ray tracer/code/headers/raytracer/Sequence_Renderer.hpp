@@ -0,0 +1,80 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <raytracer/Buffer.hpp>
+#include <raytracer/Camera_Path.hpp>
+#include <raytracer/Color.hpp>
+#include <raytracer/Path_Tracer.hpp>
+#include <raytracer/Pinhole_Camera.hpp>
+
+namespace udit::raytracer
+{
+
+    // Traza una secuencia de fotogramas siguiendo un Camera_Path y guarda cada uno en un archivo
+    // PFM. Las etapas de cada fotograma se solapan con las de sus vecinos: mientras se traza el
+    // fotograma N se preparan los rayos primarios del N+1 y se escribe en disco el N-1. Para ello
+    // se alternan dos trazadores, cada uno con su propia cámara.
+    // Se supone que la escena no cambia durante la secuencia (solo se mueve la cámara).
+
+    class Sequence_Renderer
+    {
+    public:
+
+        struct Statistics
+        {
+            unsigned frames          = 0;
+            double   seconds         = 0.0;
+            double   frames_per_hour = 0.0;
+        };
+
+    private:
+
+        struct Slot
+        {
+            Path_Tracer                       path_tracer;
+            std::unique_ptr< Pinhole_Camera > camera;
+            Buffer< Color >                   image;
+        };
+
+        Spatial_Data_Structure & space;
+        Slot                     slots[2];
+        float                    frames_per_second;
+
+    public:
+
+        Sequence_Renderer(Spatial_Data_Structure & given_space, float given_frames_per_second = 24.f);
+
+    public:
+
+        // Traza frame_count fotogramas desde el inicio del recorrido, con samples_per_pixel
+        // muestras por píxel cada uno, en output_prefix + número de fotograma + ".pfm". Devuelve
+        // los fotogramas completados y el rendimiento obtenido, para que quien llama los muestre.
+
+        Statistics render
+        (
+            const Camera_Path  & path,
+            unsigned             frame_count,
+            unsigned             viewport_width,
+            unsigned             viewport_height,
+            unsigned             samples_per_pixel,
+            const std::string  & output_prefix
+        );
+
+    private:
+
+        void prepare (Slot & slot, const Camera_Path & path, unsigned frame, unsigned viewport_width, unsigned viewport_height);
+
+        static std::string get_frame_path (const std::string & output_prefix, unsigned frame);
+
+    };
+
+}
@@ -19,6 +19,33 @@ namespace udit::raytracer
         virtual Color sample (const Vector3 & direction) const = 0;
 
         virtual ~Sky_Environment() = default;
+
+    public:
+
+        // Muestreo por importancia para la estimación directa de la luz del cielo. Los cielos que
+        // no lo admiten solo se ven cuando un rayo escapa de la escena.
+
+        virtual bool is_importance_sampled () const
+        {
+            return false;
+        }
+
+        // Elige una dirección a partir de dos valores en [0, 1), devuelve su radiancia y la
+        // densidad de probabilidad (respecto al ángulo sólido) con que se ha elegido.
+
+        virtual Color sample_direction (const Vector2 & , Vector3 & , float & pdf) const
+        {
+            pdf = 0.f;
+
+            return Color(0, 0, 0);
+        }
+
+        // Densidad con la que sample_direction() elegiría la dirección dada (normalizada).
+
+        virtual float pdf (const Vector3 & ) const
+        {
+            return 0.f;
+        }
     };
 
 }
@@ -14,7 +14,7 @@
 namespace udit::raytracer
 {
 
-    class Skydome : public Sky_Environment
+    class Skydome final : public Sky_Environment
     {
         Color     sky_color;
         Color horizon_color;
@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <array>
+
+#include <raytracer/Sampler.hpp>
+
+namespace udit::raytracer
+{
+
+    // Secuencia de Sobol con aleatorización de Owen (Burley, "Practical Hash-based Owen
+    // Scrambling", 2020). Se usan las 4 primeras dimensiones de Sobol y las siguientes se rellenan
+    // con nuevos grupos de 4 cuya semilla depende del grupo. Tanto el índice como cada dimensión se
+    // aleatorizan con una permutación anidada uniforme distinta por píxel, por lo que los píxeles
+    // no están correlacionados entre sí y cada uno conserva la buena distribución de Sobol.
+
+    class Sobol_Sampler final : public Sampler
+    {
+    public:
+
+        using Directions = std::array< std::array< uint32_t, 32 >, 4 >;
+
+        static constexpr unsigned dimensions_per_group = 4;
+
+    private:
+
+        uint32_t seed;
+        uint32_t pixel_seed;
+        uint32_t sample_index;
+        uint32_t dimension;
+
+    public:
+
+        Sobol_Sampler(uint32_t given_seed = 0)
+        {
+            seed         = given_seed;
+            pixel_seed   = 0;
+            sample_index = 0;
+            dimension    = 0;
+        }
+
+        void start (unsigned x, unsigned y, uint32_t given_sample_index) override
+        {
+            pixel_seed   = hash (hash (seed, x), y);
+            sample_index = given_sample_index;
+            dimension    = 0;
+        }
+
+        float get_1d () override
+        {
+            return to_float (sample (dimension++));
+        }
+
+        Vector2 get_2d () override
+        {
+            dimension += dimension & 1;         // Los pares empiezan en dimensión par para caer en el mismo grupo
+
+            float x = to_float (sample (dimension++));
+            float y = to_float (sample (dimension++));
+
+            return Vector2(x, y);
+        }
+
+    public:
+
+        static uint32_t sobol (uint32_t index, unsigned dimension)
+        {
+            uint32_t result = 0;
+
+            for (unsigned bit = 0; index != 0; index >>= 1, ++bit)
+            {
+                if (index & 1) result ^= directions[dimension][bit];
+            }
+
+            return result;
+        }
+
+        static uint32_t nested_uniform_scramble (uint32_t value, uint32_t seed)
+        {
+            value  = reverse_bits (value);
+            value += seed;
+            value ^= value * 0x6C50B47Cu;
+            value ^= value * 0xB82F1E52u;
+            value ^= value * 0xC7AFE638u;
+            value ^= value * 0x8D22F6E6u;
+
+            return reverse_bits (value);
+        }
+
+        static uint32_t reverse_bits (uint32_t value)
+        {
+            value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+            value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+            value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+            value = ((value >> 8) & 0x00FF00FFu) | ((value & 0x00FF00FFu) << 8);
+
+            return (value >> 16) | (value << 16);
+        }
+
+    private:
+
+        uint32_t sample (uint32_t dimension) const
+        {
+            uint32_t group_seed = hash (pixel_seed, dimension / dimensions_per_group);
+            uint32_t index      = nested_uniform_scramble (sample_index, group_seed);
+            uint32_t component  = dimension % dimensions_per_group;
+
+            return nested_uniform_scramble (sobol (index, component), hash (group_seed, component));
+        }
+
+        // Números de dirección de Joe y Kuo para las 4 primeras dimensiones. La primera es la
+        // secuencia de van der Corput.
+
+        static constexpr Directions make_directions ()
+        {
+            constexpr unsigned degrees     [4]    = { 0, 1, 2, 3 };
+            constexpr unsigned coefficients[4]    = { 0, 0, 1, 1 };
+            constexpr uint32_t initial     [4][3] = { { }, { 1 }, { 1, 3 }, { 1, 3, 1 } };
+
+            Directions result{ };
+
+            for (unsigned bit = 0; bit < 32; ++bit)
+            {
+                result[0][bit] = 1u << (31 - bit);
+            }
+
+            for (unsigned dimension = 1; dimension < 4; ++dimension)
+            {
+                unsigned s = degrees     [dimension];
+                unsigned a = coefficients[dimension];
+                auto   & v = result      [dimension];
+
+                for (unsigned bit = 0; bit < 32; ++bit)
+                {
+                    if (bit < s)
+                    {
+                        v[bit] = initial[dimension][bit] << (31 - bit);
+                    }
+                    else
+                    {
+                        v[bit] = v[bit - s] ^ (v[bit - s] >> s);
+
+                        for (unsigned k = 1; k < s; ++k)
+                        {
+                            if ((a >> (s - 1 - k)) & 1) v[bit] ^= v[bit - k];
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        static const Directions directions;
+
+    };
+
+    inline constexpr Sobol_Sampler::Directions Sobol_Sampler::directions = Sobol_Sampler::make_directions ();
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace udit::raytracer
+{
+
+    // Conexión de flujo (socket) bloqueante. Las direcciones tienen la forma "unix:/ruta/al/socket"
+    // para comunicar procesos de la misma máquina o "tcp:host:puerto" para máquinas distintas
+    // ("tcp:*:puerto" para escuchar en todas las interfaces).
+    // Solo está implementado con sockets POSIX (Linux y macOS). En otras plataformas las
+    // operaciones fallan.
+
+    class Socket
+    {
+        int handle;
+
+    public:
+
+        Socket() : handle(-1)
+        {
+        }
+
+        explicit Socket(int given_handle) : handle(given_handle)
+        {
+        }
+
+        Socket(Socket && other) noexcept : handle(std::exchange (other.handle, -1))
+        {
+        }
+
+        Socket & operator = (Socket && other) noexcept
+        {
+            if (this != &other)
+            {
+                close ();
+
+                handle = std::exchange (other.handle, -1);
+            }
+
+            return *this;
+        }
+
+        Socket(const Socket & ) = delete;
+        Socket & operator = (const Socket & ) = delete;
+
+       ~Socket()
+        {
+            close ();
+        }
+
+    public:
+
+        static Socket listen  (const std::string & address);
+        static Socket connect (const std::string & address);
+
+        Socket accept () const;
+
+    public:
+
+        bool is_open () const
+        {
+            return handle >= 0;
+        }
+
+        // Envían o reciben exactamente size bytes. Devuelven false si la conexión se ha cerrado o
+        // ha fallado.
+
+        bool send_all    (const void * data, size_t size);
+        bool receive_all (void       * data, size_t size);
+
+        // Interrumpe las operaciones bloqueadas en otros hilos sin liberar el descriptor.
+
+        void shutdown ();
+
+        void close ();
+
+    };
+
+}
@@ -7,23 +7,46 @@
 
 #pragma once
 
+#include <span>
+
 #include <raytracer/declarations.hpp>
+#include <raytracer/Generation.hpp>
 
 namespace udit::raytracer
 {
 
     class Spatial_Data_Structure
     {
+    public:
+
+        // Opciones del recorrido por lotes
+
+        enum Traversal_Flags : unsigned
+        {
+            CLOSEST_HIT = 0,
+            ANY_HIT     = 1 << 0,           // Basta con una intersección cualquiera (rayos de sombra)
+        };
+
     protected:
 
-        Scene & scene;
-        bool    ready;
+        Scene    & scene;
+        bool       ready;
+        bool       rebuilding;
+        Generation built_geometry;              // Generación de geometría de la última construcción lanzada
+        Generation fitted_transforms;           // Generación de transformaciones de los volúmenes actuales
+        Generation launched_transforms;
+        Generation version;                     // Cambia cada vez que update() encuentra cambios
 
     public:
 
         Spatial_Data_Structure(Scene & given_scene) : scene(given_scene)
         {
-            ready = false;
+            ready               = false;
+            rebuilding          = false;
+            built_geometry      = 0;
+            fitted_transforms   = 0;
+            launched_transforms = 0;
+            version             = 0;
         }
 
         virtual ~Spatial_Data_Structure() = default;
@@ -40,12 +63,72 @@ namespace udit::raytracer
             return ready;
         }
 
+        bool is_rebuilding () const
+        {
+            return rebuilding;
+        }
+
+        // Pone la estructura al día con la escena e indica si ha cambiado lo que se ve. Si la
+        // comparten varios trazadores, solo el primero que la actualiza recibe true; los demás
+        // deben comparar get_version() con la última que vieron.
+
+        bool update ();
+
+        Generation get_version () const
+        {
+            return version;
+        }
+
     public:
 
         virtual void classify_intersectables () = 0;
 
         virtual bool traverse (const Ray & ray, float min_t, float max_t, Intersection & intersection) const = 0;
 
+        // Devuelve una primitiva con la que choca el rayo en (min_t, max_t), o nullptr si no choca
+        // con ninguna. No calcula ni el punto ni la normal, por lo que sirve para rayos de sombra y
+        // pruebas de visibilidad. Por defecto busca la intersección más cercana; las estructuras
+        // que puedan deben redefinirla para terminar con la primera que encuentren.
+
+        virtual Intersectable * occluded (const Ray & ray, float min_t, float max_t) const;
+
+        // Recorrido de un lote de rayos. Deja en intersections[i] el resultado del rayo i, con
+        // intersectable a nullptr si no ha chocado con nada (con ANY_HIT, solo intersectable es
+        // válido). Las implementaciones pueden reordenar el trabajo entre rayos; la versión por
+        // defecto los recorre de uno en uno, con occluded() si basta con cualquier intersección.
+
+        virtual void traverse
+        (
+            std::span< const Ray > rays,
+            std::span< Intersection > intersections,
+            unsigned flags,
+            float    min_t,
+            float    max_t
+        ) const;
+
+    protected:
+
+        // Reajusta los volúmenes envolventes de la versión actual sin reconstruirla.
+
+        virtual void refit ()
+        {
+        }
+
+        // Lanza la reconstrucción en segundo plano. Mientras no termine, traverse() sigue usando
+        // la versión anterior. Por defecto se reconstruye de forma síncrona.
+
+        virtual void start_rebuild ()
+        {
+            classify_intersectables ();
+        }
+
+        // Sustituye la versión actual por la reconstruida si ya está lista (sin bloquear).
+
+        virtual bool finish_rebuild ()
+        {
+            return true;
+        }
+
     };
 
 }
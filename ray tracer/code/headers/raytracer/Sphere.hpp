@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
 #include <raytracer/Intersectable.hpp>
 
 namespace udit::raytracer
@@ -26,10 +30,35 @@ namespace udit::raytracer
 
         float intersect (const Ray & ray, float min_t, float max_t) const override;
 
+        void  intersect (std::span< const Ray > rays, float min_t, std::span< Intersection > intersections) const override;
+
         Vector3 normal_at (const Vector3 & point) const override
         {
             return (point - center) / radius;
         }
+
+        Bounding_Box get_bounding_box () const override
+        {
+            return Bounding_Box(center - Vector3(radius), center + Vector3(radius));
+        }
+
+        // Longitud y latitud, con v = 0 en el polo superior
+
+        Vector2 texture_coordinates_at (const Vector3 & point) const override
+        {
+            Vector3 direction = (point - center) / radius;
+
+            return Vector2
+            (
+                .5f + std::atan2 (direction.z, direction.x) * (.5f * std::numbers::inv_pi_v< float >),
+                std::acos (std::clamp (direction.y, -1.f, 1.f)) * std::numbers::inv_pi_v< float >
+            );
+        }
+
+        float get_texture_scale () const override
+        {
+            return std::numbers::pi_v< float > * radius;
+        }
     };
 
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <raytracer/Sampler.hpp>
+
+namespace udit::raytracer
+{
+
+    // Muestreo estratificado con jitter. Cada bloque de strata x strata muestras consecutivas de un
+    // píxel cubre una vez cada estrato (strata² en 1D, una rejilla de strata x strata en 2D). El
+    // orden en que se recorren los estratos se baraja por píxel, dimensión y bloque para que las
+    // dimensiones no queden correlacionadas entre sí.
+
+    class Stratified_Sampler final : public Sampler
+    {
+        uint32_t seed;
+        uint32_t strata;
+        uint32_t pixel_seed;
+        uint32_t sample_index;
+        uint32_t dimension;
+
+    public:
+
+        Stratified_Sampler(uint32_t given_strata = 4, uint32_t given_seed = 0)
+        {
+            strata       = given_strata > 0 ? given_strata : 1;
+            seed         = given_seed;
+            pixel_seed   = 0;
+            sample_index = 0;
+            dimension    = 0;
+        }
+
+        void start (unsigned x, unsigned y, uint32_t given_sample_index) override
+        {
+            pixel_seed   = hash (hash (seed, x), y);
+            sample_index = given_sample_index;
+            dimension    = 0;
+        }
+
+        float get_1d () override
+        {
+            uint32_t count    = strata * strata;
+            uint32_t scramble = hash (hash (pixel_seed, dimension), sample_index / count);
+            uint32_t stratum  = permute (sample_index % count, count, scramble);
+            float    jitter   = to_float (hash (scramble, sample_index));
+
+            dimension++;
+
+            return (float(stratum) + jitter) / float(count);
+        }
+
+        Vector2 get_2d () override
+        {
+            uint32_t count    = strata * strata;
+            uint32_t scramble = hash (hash (pixel_seed, dimension), sample_index / count);
+            uint32_t stratum  = permute (sample_index % count, count, scramble);
+            float    jitter_x = to_float (hash (scramble, 2 * sample_index    ));
+            float    jitter_y = to_float (hash (scramble, 2 * sample_index + 1));
+
+            dimension += 2;
+
+            return Vector2
+            (
+                (float(stratum % strata) + jitter_x) / float(strata),
+                (float(stratum / strata) + jitter_y) / float(strata)
+            );
+        }
+
+    private:
+
+        // Permutación de [0, count) que depende de la semilla (Kensler, "Correlated Multi-Jittered
+        // Sampling", 2013).
+
+        static uint32_t permute (uint32_t index, uint32_t count, uint32_t seed)
+        {
+            uint32_t mask = count - 1;
+
+            mask |= mask >> 1; mask |= mask >> 2; mask |= mask >> 4; mask |= mask >> 8; mask |= mask >> 16;
+
+            do
+            {
+                index ^= seed;              index *= 0xE170893Du;
+                index ^= seed >> 16;
+                index ^= (index & mask) >> 4;
+                index ^= seed >> 8;         index *= 0x0929EB3Fu;
+                index ^= seed >> 23;
+                index ^= (index & mask) >> 1; index *= 1 | seed >> 27;
+                index *= 0x6935FA69u;
+                index ^= (index & mask) >> 11; index *= 0x74DCB303u;
+                index ^= (index & mask) >> 2;  index *= 0x9E501CC3u;
+                index ^= (index & mask) >> 2;  index *= 0xC860A3DFu;
+                index &= mask;
+                index ^= index >> 5;
+            }
+            while (index >= count);
+
+            return (index + seed) % count;
+        }
+    };
+
+}
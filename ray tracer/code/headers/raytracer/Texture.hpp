@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include <raytracer/Color.hpp>
+#include <raytracer/math.hpp>
+#include <raytracer/Texture_Cache.hpp>
+
+namespace udit::raytracer
+{
+
+    // Imagen con mipmaps guardada en un fichero preparado con convert(). Cada nivel está dividido
+    // en baldosas de 32x32 texels en sRGB de 8 bits (4 KB, una página), de modo que leer una
+    // baldosa es leer una página del fichero proyectado en memoria. Las baldosas se decodifican
+    // solo cuando se necesitan y se guardan en la caché compartida de la escena; la página se
+    // devuelve al sistema después, así que la memoria que ocupan las texturas la limita la caché.
+    // Solo está implementado con POSIX (Linux y macOS). En otras plataformas no se carga y se
+    // comporta como una textura blanca.
+
+    class Texture
+    {
+    public:
+
+        static constexpr unsigned tile_size   = Texture_Cache::tile_size;
+        static constexpr uint32_t version     = 1;
+        static constexpr unsigned max_levels  = 16;
+        static constexpr size_t   data_offset = 4096;
+        static constexpr size_t   tile_bytes  = tile_size * tile_size * 4;
+
+        struct Header
+        {
+            char     magic[8];
+            uint32_t version;
+            uint32_t width;
+            uint32_t height;
+            uint32_t levels;
+            uint64_t level_offsets[max_levels];         // Primera baldosa de cada nivel en el fichero
+        };
+
+        static_assert(sizeof(Header) <= data_offset);
+
+    private:
+
+        struct Level
+        {
+            unsigned width;
+            unsigned height;
+            unsigned tiles_x;
+            uint64_t offset;
+        };
+
+        Texture_Cache & cache;
+        uint32_t        id;
+        int             file;
+        const uint8_t * mapping;
+        size_t          mapping_size;
+        unsigned        level_count;
+        Level           levels[max_levels];
+
+    public:
+
+        Texture(Texture_Cache & given_cache, const std::string & path);
+
+        Texture(const Texture & ) = delete;
+        Texture & operator = (const Texture & ) = delete;
+
+       ~Texture();
+
+    public:
+
+        bool is_loaded () const
+        {
+            return mapping != nullptr;
+        }
+
+        unsigned get_width () const
+        {
+            return level_count > 0 ? levels[0].width : 0;
+        }
+
+        unsigned get_height () const
+        {
+            return level_count > 0 ? levels[0].height : 0;
+        }
+
+        // Color en las coordenadas uv (que se repiten fuera de [0, 1)) filtrado para una huella
+        // de footprint unidades de uv: se elige el nivel cuyo texel es de ese tamaño y se mezcla
+        // con el siguiente (filtrado trilineal).
+
+        Color sample (const Vector2 & uv, float footprint) const;
+
+        // Prepara el fichero de una textura a partir de sus texels en color lineal, por filas
+
+        static bool convert (const std::string & path, unsigned width, unsigned height, std::span< const Color > texels);
+
+    private:
+
+        Color sample_level (unsigned level, const Vector2 & uv) const;
+
+        const Texture_Cache::Tile & get_tile (unsigned level, unsigned tile_x, unsigned tile_y) const;
+
+        void load_tile (unsigned level, unsigned tile_x, unsigned tile_y, Texture_Cache::Tile & tile) const;
+
+    };
+
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <raytracer/Color.hpp>
+
+namespace udit::raytracer
+{
+
+    // Baldosas de textura ya decodificadas que comparten todas las texturas de una escena. Guarda
+    // como mucho las que caben en la capacidad dada y, cuando se llena, descarta las que hace más
+    // tiempo que no se usan, de modo que la memoria no depende del tamaño de las texturas. Está
+    // repartida en fragmentos con su propio mutex para que los hilos que trazan no se estorben.
+
+    class Texture_Cache
+    {
+    public:
+
+        static constexpr unsigned tile_size        = 32;                    // Texels por lado
+        static constexpr size_t   default_capacity = size_t(256) << 20;     // Bytes
+
+        using Tile     = std::array< Color, tile_size * tile_size >;
+        using Tile_Ptr = std::shared_ptr< const Tile >;
+
+        struct Statistics
+        {
+            uint64_t hits;
+            uint64_t misses;
+        };
+
+    private:
+
+        static constexpr unsigned shard_count = 16;
+
+        struct Shard
+        {
+            using Order = std::list< uint64_t >;
+
+            struct Entry
+            {
+                Tile_Ptr         tile;
+                Order::iterator  position;
+            };
+
+            std::mutex                              mutex;
+            Order                                   order;          // Del uso más reciente al más antiguo
+            std::unordered_map< uint64_t, Entry >   entries;
+        };
+
+        std::array< Shard, shard_count > shards;
+        size_t                           tiles_per_shard;
+        std::atomic< uint64_t >          hits;
+        std::atomic< uint64_t >          misses;
+
+        static inline std::atomic< uint32_t > next_texture_id = 0;
+
+    public:
+
+        Texture_Cache(size_t capacity = default_capacity)
+        {
+            hits   = 0;
+            misses = 0;
+
+            set_capacity (capacity);
+        }
+
+        Texture_Cache(const Texture_Cache & ) = delete;
+        Texture_Cache & operator = (const Texture_Cache & ) = delete;
+
+        // Las baldosas que sobren se descartan a medida que se pidan otras
+
+        void set_capacity (size_t capacity)
+        {
+            tiles_per_shard = std::max< size_t > (1, capacity / sizeof(Tile) / shard_count);
+        }
+
+        size_t get_capacity () const
+        {
+            return tiles_per_shard * shard_count * sizeof(Tile);
+        }
+
+        Statistics get_statistics () const
+        {
+            return { hits.load (std::memory_order_relaxed), misses.load (std::memory_order_relaxed) };
+        }
+
+        // Cada textura tiene un identificador distinto con el que forma las claves de sus baldosas.
+        // No se repite ni entre cachés distintas, así que una clave identifica una baldosa aunque se
+        // guarde fuera de la caché (ver Texture::get_tile()).
+
+        uint32_t register_texture ()
+        {
+            return next_texture_id++;
+        }
+
+        // Devuelve la baldosa de la clave dada. Si no está, la prepara load(Tile &). La baldosa
+        // sigue siendo válida mientras se tenga el puntero, aunque la caché la haya descartado.
+
+        template< class LOADER >
+        Tile_Ptr get (uint64_t key, LOADER && load)
+        {
+            auto & shard = shards[(key * 0x9E3779B97F4A7C15ull) >> 60];
+
+            {
+                std::lock_guard lock(shard.mutex);
+
+                if (auto tile = find (shard, key))
+                {
+                    hits.fetch_add (1, std::memory_order_relaxed);
+
+                    return tile;
+                }
+            }
+
+            misses.fetch_add (1, std::memory_order_relaxed);
+
+            // Se decodifica sin el mutex, para que los demás hilos sigan usando el fragmento
+            // mientras tanto. Si otro hilo ha cargado la misma baldosa a la vez, se usa la suya.
+
+            auto tile = std::make_shared< Tile > ();
+
+            load (*tile);
+
+            std::lock_guard lock(shard.mutex);
+
+            if (auto loaded = find (shard, key)) return loaded;
+
+            while (shard.entries.size () >= tiles_per_shard)
+            {
+                shard.entries.erase (shard.order.back ());
+                shard.order  .pop_back ();
+            }
+
+            shard.order.push_front (key);
+            shard.entries.emplace  (key, Shard::Entry{ tile, shard.order.begin () });
+
+            return tile;
+        }
+
+    private:
+
+        // Se llama con el mutex del fragmento bloqueado
+
+        static Tile_Ptr find (Shard & shard, uint64_t key)
+        {
+            auto found = shard.entries.find (key);
+
+            if (found == shard.entries.end ()) return nullptr;
+
+            shard.order.splice (shard.order.begin (), shard.order, found->second.position);
+
+            return found->second.tile;
+        }
+
+    };
+
+}
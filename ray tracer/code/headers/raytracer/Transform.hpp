@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <raytracer/Generation.hpp>
 #include <raytracer/math.hpp>
 
 namespace udit::raytracer
@@ -22,15 +23,25 @@ namespace udit::raytracer
         unsigned cached;
         unsigned changed;
 
+        Generation_Counter * generation;
+
     public:
 
         Transform()
         {
-            position = Vector3(0);
-            rotation = Vector3(0);
-            scales   = Vector3(1);
-            cached   = false;
-            changed  = false;
+            position   = Vector3(0);
+            rotation   = Vector3(0);
+            scales     = Vector3(1);
+            cached     = false;
+            changed    = false;
+            generation = nullptr;
+        }
+
+        // Asocia la transformación a un contador que se incrementará con cada cambio
+
+        void track (Generation_Counter & counter)
+        {
+            generation = &counter;
         }
 
         bool has_changed (bool reset)
@@ -52,6 +63,8 @@ namespace udit::raytracer
             {
                 position  = new_position;
                 cached    = false;
+
+                advance (generation);
             }
         }
 
@@ -61,6 +74,8 @@ namespace udit::raytracer
             {
                 rotation  = new_rotation;
                 cached    = false;
+
+                advance (generation);
             }
         }
 
@@ -70,6 +85,8 @@ namespace udit::raytracer
             {
                 scales  = new_scales;
                 cached = false;
+
+                advance (generation);
             }
         }
 
@@ -17,9 +17,11 @@ namespace udit::raytracer
     struct Model;
     struct Node;
     struct Ray;
+    class  Sampler;
     class  Scene;
     class  Sky_Environment;
     class  Spatial_Data_Structure;
+    class  Texture;
     class  Transform;
 
 }
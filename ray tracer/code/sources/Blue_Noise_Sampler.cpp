@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <raytracer/Blue_Noise_Sampler.hpp>
+#include <raytracer/Random.hpp>
+
+namespace udit::raytracer
+{
+
+    namespace
+    {
+
+        // Energía de cada texel: suma de gaussianas centradas en los texels ocupados medida sobre
+        // el toro, para que la máscara pueda repetirse sin costuras.
+
+        class Energy_Field
+        {
+            static constexpr int   size  = int(Blue_Noise_Sampler::mask_size);
+            static constexpr float sigma = 1.5f;
+
+            std::vector< float > kernel;
+            std::vector< float > energy;
+
+        public:
+
+            std::vector< bool  > occupied;
+
+        public:
+
+            Energy_Field() : kernel(size * size), energy(size * size, 0.f), occupied(size * size, false)
+            {
+                for (int dy = 0; dy < size; ++dy)
+                {
+                    for (int dx = 0; dx < size; ++dx)
+                    {
+                        int wx = std::min (dx, size - dx);
+                        int wy = std::min (dy, size - dy);
+
+                        kernel[dy * size + dx] = std::exp (-float(wx * wx + wy * wy) / (2.f * sigma * sigma));
+                    }
+                }
+            }
+
+            void toggle (int index)
+            {
+                float sign = occupied[index] ? -1.f : 1.f;
+                int   cx   = index % size;
+                int   cy   = index / size;
+
+                occupied[index] = not occupied[index];
+
+                for (int y = 0; y < size; ++y)
+                {
+                    int dy = (y - cy + size) % size;
+
+                    for (int x = 0; x < size; ++x)
+                    {
+                        energy[y * size + x] += sign * kernel[dy * size + (x - cx + size) % size];
+                    }
+                }
+            }
+
+            // El texel ocupado con más energía (el grupo más apretado) o el libre con menos (el
+            // mayor hueco).
+
+            int tightest_cluster () const
+            {
+                int   best   = -1;
+                float energy_max = -1.f;
+
+                for (int index = 0; index < size * size; ++index)
+                {
+                    if (occupied[index] && energy[index] > energy_max) { energy_max = energy[index]; best = index; }
+                }
+
+                return best;
+            }
+
+            int largest_void () const
+            {
+                int   best   = -1;
+                float energy_min = 1e30f;
+
+                for (int index = 0; index < size * size; ++index)
+                {
+                    if (not occupied[index] && energy[index] < energy_min) { energy_min = energy[index]; best = index; }
+                }
+
+                return best;
+            }
+        };
+
+        Blue_Noise_Sampler::Mask generate_mask ()
+        {
+            constexpr int texel_count   = int(Blue_Noise_Sampler::mask_size * Blue_Noise_Sampler::mask_size);
+            constexpr int initial_count = texel_count / 10;
+
+            Energy_Field field;
+            Random       random(0x2545F491u);
+
+            // Patrón inicial aleatorio que se relaja moviendo el grupo más apretado al mayor hueco
+            // hasta que deja de cambiar.
+
+            for (int placed = 0; placed < initial_count; )
+            {
+                int index = int(random.next_uint32 () % texel_count);
+
+                if (not field.occupied[index]) { field.toggle (index); ++placed; }
+            }
+
+            for (int iteration = 0; iteration < texel_count; ++iteration)
+            {
+                int cluster = field.tightest_cluster ();
+
+                field.toggle (cluster);
+
+                int hole = field.largest_void ();
+
+                field.toggle (hole);
+
+                if (hole == cluster) break;
+            }
+
+            std::vector< int > ranks(texel_count, 0);
+
+            // Fase 1: los puntos del patrón inicial reciben los primeros rangos quitando cada vez el
+            // grupo más apretado. Fase 2: se ocupa el resto llenando cada vez el mayor hueco.
+
+            Energy_Field initial = field;
+
+            for (int rank = initial_count - 1; rank >= 0; --rank)
+            {
+                int cluster = initial.tightest_cluster ();
+
+                initial.toggle (cluster);
+
+                ranks[cluster] = rank;
+            }
+
+            for (int rank = initial_count; rank < texel_count; ++rank)
+            {
+                int hole = field.largest_void ();
+
+                field.toggle (hole);
+
+                ranks[hole] = rank;
+            }
+
+            Blue_Noise_Sampler::Mask mask;
+
+            for (int index = 0; index < texel_count; ++index)
+            {
+                mask[index] = (float(ranks[index]) + 0.5f) / float(texel_count);
+            }
+
+            return mask;
+        }
+
+    }
+
+    const Blue_Noise_Sampler::Mask & Blue_Noise_Sampler::get_mask ()
+    {
+        static const Mask mask = generate_mask ();
+
+        return mask;
+    }
+
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numbers>
+
+#include <raytracer/Environment_Map.hpp>
+
+namespace udit::raytracer
+{
+
+    namespace
+    {
+
+        constexpr float pi = std::numbers::pi_v< float >;
+
+        float luminance (const Color & color)
+        {
+            return std::max (0.f, 0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b);
+        }
+
+        // Devuelve el índice del tramo de la CDF en el que cae value y la posición dentro de él.
+
+        unsigned find_interval (const float * cdf, unsigned count, float value, float & offset)
+        {
+            auto     upper = std::upper_bound (cdf, cdf + count + 1, value);
+            unsigned index = static_cast< unsigned >(std::clamp< ptrdiff_t > (upper - cdf - 1, 0, count - 1));
+            float    width = cdf[index + 1] - cdf[index];
+
+            offset = width > 0.f ? std::clamp ((value - cdf[index]) / width, 0.f, 1.f) : 0.5f;
+
+            return index;
+        }
+
+    }
+
+    Environment_Map::Environment_Map(const std::string & path, float given_intensity)
+    {
+        intensity    = given_intensity;
+        total_weight = 0.f;
+
+        char magic[2] = { 0, 0 };
+
+        std::ifstream (path, std::ios::binary).read (magic, 2);
+
+        bool loaded = magic[0] == 'P' && (magic[1] == 'F' || magic[1] == 'f') ? load_pfm  (path, image)
+                    : magic[0] == '#' &&  magic[1] == '?'                    ? load_rgbe (path, image)
+                    : false;
+
+        if (loaded)
+        {
+            build_distribution ();
+        }
+        else
+        {
+            image = Image();
+        }
+    }
+
+    Color Environment_Map::sample (const Vector3 & direction) const
+    {
+        if (image.empty ()) return Color(0, 0, 0);
+
+        auto uv = direction_to_uv (direction);
+
+        return lookup (uv.x, uv.y) * intensity;
+    }
+
+    Color Environment_Map::sample_direction (const Vector2 & random_point, Vector3 & direction, float & pdf) const
+    {
+        unsigned width  = image.get_width  ();
+        unsigned height = image.get_height ();
+
+        float    row_offset;
+        float    column_offset;
+        unsigned row     = find_interval (marginal_cdf.data (), height, random_point.x, row_offset);
+        auto     row_cdf = conditional_cdfs.data () + row * (width + 1);
+        unsigned column  = find_interval (row_cdf, width, random_point.y, column_offset);
+
+        float u = (float(column) + column_offset) / float(width );
+        float v = (float(row   ) +    row_offset) / float(height);
+
+        float sin_theta = std::sin (pi * v);
+        float uv_pdf    = (marginal_cdf[row + 1] - marginal_cdf[row]) * float(height)
+                        * (row_cdf[column + 1]   - row_cdf[column]  ) * float(width );
+
+        direction = uv_to_direction (u, v);
+        pdf       = sin_theta > 0.f ? uv_pdf / (2.f * pi * pi * sin_theta) : 0.f;
+
+        return lookup (u, v) * intensity;
+    }
+
+    float Environment_Map::pdf (const Vector3 & direction) const
+    {
+        if (total_weight <= 0.f) return 0.f;
+
+        unsigned width     = image.get_width  ();
+        unsigned height    = image.get_height ();
+        auto     uv        = direction_to_uv (direction);
+        unsigned column    = std::min (unsigned(uv.x * float(width )), width  - 1);
+        unsigned row       = std::min (unsigned(uv.y * float(height)), height - 1);
+        auto     row_cdf   = conditional_cdfs.data () + row * (width + 1);
+        float    sin_theta = std::sqrt (std::max (0.f, 1.f - direction.y * direction.y));
+
+        if (sin_theta <= 0.f) return 0.f;
+
+        float uv_pdf = (marginal_cdf[row + 1] - marginal_cdf[row]) * float(height)
+                     * (row_cdf[column + 1]   - row_cdf[column]  ) * float(width );
+
+        return uv_pdf / (2.f * pi * pi * sin_theta);
+    }
+
+    // Interpolación bilineal entre los centros de los texels. En horizontal la imagen se repite y
+    // en vertical se satura en los polos.
+
+    Color Environment_Map::lookup (float u, float v) const
+    {
+        int   width  = int(image.get_width  ());
+        int   height = int(image.get_height ());
+        float x      = u * float(width ) - 0.5f;
+        float y      = v * float(height) - 0.5f;
+        float x0     = std::floor (x);
+        float y0     = std::floor (y);
+        float fx     = x - x0;
+        float fy     = y - y0;
+
+        int left   = ((int(x0) % width) + width) % width;
+        int right  = (left + 1) % width;
+        int top    = std::clamp (int(y0)    , 0, height - 1);
+        int bottom = std::clamp (int(y0) + 1, 0, height - 1);
+
+        Color upper = mix (image.get (unsigned(left), unsigned(top   )), image.get (unsigned(right), unsigned(top   )), fx);
+        Color lower = mix (image.get (unsigned(left), unsigned(bottom)), image.get (unsigned(right), unsigned(bottom)), fx);
+
+        return mix (upper, lower, fy);
+    }
+
+    void Environment_Map::build_distribution ()
+    {
+        unsigned width  = image.get_width  ();
+        unsigned height = image.get_height ();
+
+        marginal_cdf    .assign (height + 1, 0.f);
+        conditional_cdfs.assign (size_t(height) * (width + 1), 0.f);
+
+        for (unsigned row = 0; row < height; ++row)
+        {
+            float   sin_theta = std::sin (pi * (float(row) + 0.5f) / float(height));
+            float * row_cdf   = conditional_cdfs.data () + row * (width + 1);
+
+            for (unsigned column = 0; column < width; ++column)
+            {
+                row_cdf[column + 1] = row_cdf[column] + luminance (image.get (column, row)) * sin_theta;
+            }
+
+            float row_weight = row_cdf[width];
+
+            for (unsigned column = 1; column <= width; ++column)
+            {
+                row_cdf[column] = row_weight > 0.f ? row_cdf[column] / row_weight : float(column) / float(width);
+            }
+
+            marginal_cdf[row + 1] = marginal_cdf[row] + row_weight;
+        }
+
+        total_weight = marginal_cdf[height];
+
+        if (total_weight > 0.f)
+        {
+            for (auto & value : marginal_cdf) value /= total_weight;
+        }
+    }
+
+    Vector2 Environment_Map::direction_to_uv (const Vector3 & direction)
+    {
+        return Vector2
+        (
+            0.5f + std::atan2 (direction.x, -direction.z) / (2.f * pi),
+            std::acos (std::clamp (direction.y, -1.f, 1.f)) / pi
+        );
+    }
+
+    Vector3 Environment_Map::uv_to_direction (float u, float v)
+    {
+        float phi       = (u - 0.5f) * 2.f * pi;
+        float theta     = v * pi;
+        float sin_theta = std::sin (theta);
+
+        return Vector3(sin_theta * std::sin (phi), std::cos (theta), -sin_theta * std::cos (phi));
+    }
+
+    // PFM: cabecera de texto ("PF" color o "Pf" gris, ancho, alto y escala, cuyo signo negativo
+    // indica little endian) seguida de floats con las filas de abajo a arriba.
+
+    bool Environment_Map::load_pfm (const std::string & path, Image & image)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string   magic;
+        unsigned      width  = 0;
+        unsigned      height = 0;
+        float         scale  = 0.f;
+
+        file >> magic >> width >> height >> scale;
+        file.get ();
+
+        if (not file || width == 0 || height == 0 || scale == 0.f) return false;
+
+        unsigned channels = magic == "PF" ? 3 : 1;
+
+        std::vector< uint32_t > data(size_t(width) * height * channels);
+
+        if (not file.read (reinterpret_cast< char * >(data.data ()), std::streamsize(data.size () * 4))) return false;
+
+        bool swap = (scale < 0.f) != (std::endian::native == std::endian::little);
+
+        image.resize (width, height);
+
+        for (unsigned row = 0; row < height; ++row)
+        {
+            for (unsigned column = 0; column < width; ++column)
+            {
+                float rgb[3];
+
+                for (unsigned channel = 0; channel < 3; ++channel)
+                {
+                    uint32_t bits = data[(size_t(row) * width + column) * channels + (channel < channels ? channel : 0)];
+
+                    if (swap) bits = (bits >> 24) | ((bits >> 8) & 0xFF00u) | ((bits << 8) & 0xFF0000u) | (bits << 24);
+
+                    std::memcpy (&rgb[channel], &bits, 4);
+                }
+
+                image.set (column, height - 1 - row, Color(rgb[0], rgb[1], rgb[2]));
+            }
+        }
+
+        return true;
+    }
+
+    // Radiance RGBE (.hdr): cabecera de texto terminada en una línea vacía, resolución en la forma
+    // "-Y alto +X ancho" y filas de arriba a abajo, planas o con el RLE por canales habitual.
+
+    bool Environment_Map::load_rgbe (const std::string & path, Image & image)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string   line;
+
+        if (not std::getline (file, line) || line.rfind ("#?", 0) != 0) return false;
+
+        while (std::getline (file, line) && not line.empty ())
+        {
+            if (line.rfind ("FORMAT=", 0) == 0 && line != "FORMAT=32-bit_rle_rgbe") return false;
+        }
+
+        unsigned width  = 0;
+        unsigned height = 0;
+
+        if (not std::getline (file, line) || std::sscanf (line.c_str (), "-Y %u +X %u", &height, &width) != 2) return false;
+
+        if (width == 0 || height == 0) return false;
+
+        std::vector< uint8_t > scanline(size_t(width) * 4);
+
+        image.resize (width, height);
+
+        for (unsigned row = 0; row < height; ++row)
+        {
+            uint8_t header[4];
+
+            if (not file.read (reinterpret_cast< char * >(header), 4)) return false;
+
+            bool run_length_encoded = width >= 8 && width < 32768 && header[0] == 2 && header[1] == 2
+                                   && ((unsigned(header[2]) << 8) | header[3]) == width;
+
+            if (run_length_encoded)
+            {
+                for (unsigned channel = 0; channel < 4; ++channel)
+                {
+                    for (unsigned column = 0; column < width; )
+                    {
+                        int count = file.get ();
+
+                        if (count == EOF) return false;
+
+                        if (count > 128)
+                        {
+                            int value = file.get ();
+
+                            count -= 128;
+
+                            if (value == EOF || unsigned(count) > width - column) return false;
+
+                            while (count--) scanline[size_t(column++) * 4 + channel] = uint8_t(value);
+                        }
+                        else
+                        {
+                            if (count == 0 || unsigned(count) > width - column) return false;
+
+                            while (count--)
+                            {
+                                int value = file.get ();
+
+                                if (value == EOF) return false;
+
+                                scanline[size_t(column++) * 4 + channel] = uint8_t(value);
+                            }
+                        }
+                    }
+                }
+            }
+            else
+            {
+                std::memcpy (scanline.data (), header, 4);
+
+                if (not file.read (reinterpret_cast< char * >(scanline.data () + 4), std::streamsize(scanline.size () - 4))) return false;
+            }
+
+            for (unsigned column = 0; column < width; ++column)
+            {
+                const uint8_t * rgbe     = scanline.data () + size_t(column) * 4;
+                float           exponent = rgbe[3] ? std::ldexp (1.f, int(rgbe[3]) - (128 + 8)) : 0.f;
+
+                image.set (column, row, Color(rgbe[0] * exponent, rgbe[1] * exponent, rgbe[2] * exponent));
+            }
+        }
+
+        return true;
+    }
+
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <fstream>
+#include <vector>
+
+#include <raytracer/Image_File.hpp>
+
+namespace udit::raytracer
+{
+
+    // Cabecera de texto y las filas de abajo arriba en floats rgb (-1 = little endian)
+
+    bool Image_File::write_pfm (const std::string & path, const Buffer< Color > & image)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        if (not file) return false;
+
+        unsigned width  = image.get_width  ();
+        unsigned height = image.get_height ();
+
+        file << "PF\n" << width << ' ' << height << "\n-1.0\n";
+
+        std::vector< float > row(size_t(width) * 3);
+
+        for (unsigned y = height; y-- > 0; )
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                auto & color = image.get (x, y);
+
+                row[x * 3 + 0] = color.r;
+                row[x * 3 + 1] = color.g;
+                row[x * 3 + 2] = color.b;
+            }
+
+            file.write (reinterpret_cast< const char * >(row.data ()), std::streamsize(row.size () * sizeof(float)));
+        }
+
+        return bool(file);
+    }
+
+}
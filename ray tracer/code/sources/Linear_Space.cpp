@@ -5,6 +5,10 @@
  * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
  */
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
 #include <raytracer/Intersectable.hpp>
 #include <raytracer/Intersection.hpp>
 #include <raytracer/Linear_Space.hpp>
@@ -16,23 +20,7 @@ namespace udit::raytracer
 
     void Linear_Space::classify_intersectables ()
     {
-        size_t number_of_intersectables = 0;
-
-        for (auto & model : scene)
-        {
-            number_of_intersectables += model.intersectables.size ();
-        }
-
-        intersectables.clear   ();
-        intersectables.reserve (number_of_intersectables);
-
-        for (auto & model : scene)
-        {
-            for (auto & intersectable : model.intersectables)
-            {
-                intersectables.push_back (intersectable);
-            }
-        }
+        current_version = build_version (gather_intersectables ());
 
         ready = true;
     }
@@ -41,7 +29,7 @@ namespace udit::raytracer
     {
         closest_intersection.t = max_t;
 
-        for (auto & intersectable : intersectables)
+        for (auto & intersectable : current_version->unbounded_intersectables)
         {
             float t = intersectable->intersect (ray, min_t, closest_intersection.t);
 
@@ -52,6 +40,27 @@ namespace udit::raytracer
             }
         }
 
+        if (current_version->bounding_box.intersects (ray, min_t, closest_intersection.t))
+        {
+            for (auto & model : current_version->bounded_models)
+            {
+                // Con el t más cercano hasta ahora se descartan también los modelos que quedan detrás
+
+                if (not model.bounding_box.intersects (ray, min_t, closest_intersection.t)) continue;
+
+                for (auto & intersectable : model.intersectables)
+                {
+                    float t = intersectable->intersect (ray, min_t, closest_intersection.t);
+
+                    if (t > 0.f)
+                    {
+                        closest_intersection.t = t;
+                        closest_intersection.intersectable = intersectable;
+                    }
+                }
+            }
+        }
+
         if (closest_intersection.t < max_t)
         {
             closest_intersection.point  = ray.point_at (closest_intersection.t);
@@ -63,4 +72,381 @@ namespace udit::raytracer
         return false;
     }
 
+    Intersectable * Linear_Space::occluded (const Ray & ray, float min_t, float max_t) const
+    {
+        if (current_version->bounding_box.intersects (ray, min_t, max_t))
+        {
+            for (auto & model : current_version->bounded_models)
+            {
+                if (not model.bounding_box.intersects (ray, min_t, max_t)) continue;
+
+                for (auto & intersectable : model.intersectables)
+                {
+                    if (intersectable->intersect (ray, min_t, max_t) > 0.f)
+                    {
+                        return intersectable;
+                    }
+                }
+            }
+        }
+
+        for (auto & intersectable : current_version->unbounded_intersectables)
+        {
+            if (intersectable->intersect (ray, min_t, max_t) > 0.f)
+            {
+                return intersectable;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // El lote se recorre primitiva a primitiva en lugar de rayo a rayo: cada primitiva se carga una
+    // vez y se prueba contra todos los rayos con una sola llamada virtual. Los rayos que no
+    // atraviesan la caja de la escena, y después la de cada modelo, se apartan antes de probar sus
+    // primitivas si estas son bastantes.
+
+    void Linear_Space::traverse
+    (
+        std::span< const Ray > rays,
+        std::span< Intersection > intersections,
+        unsigned flags,
+        float    min_t,
+        float    max_t
+    ) const
+    {
+        assert(rays.size () == intersections.size ());
+
+        for (auto & intersection : intersections)
+        {
+            intersection.t             = max_t;
+            intersection.intersectable = nullptr;
+        }
+
+        intersect_list (current_version->unbounded_intersectables, rays, intersections, flags, min_t);
+
+        auto & version = *current_version;
+
+        if (version.bounded_count < box_culling_threshold)
+        {
+            intersect_models (version, rays, intersections, flags, min_t);
+        }
+        else
+        {
+            // Los búferes se reutilizan entre llamadas en cada hilo
+
+            thread_local Culling_Buffers buffers;
+
+            cull_by_box
+            (
+                version.bounding_box, rays, intersections, flags, min_t, buffers,
+                [&](std::span< const Ray > box_rays, std::span< Intersection > box_intersections)
+                {
+                    intersect_models (version, box_rays, box_intersections, flags, min_t);
+                }
+            );
+        }
+
+        if (not (flags & ANY_HIT))
+        {
+            for (size_t index = 0; index < rays.size (); ++index)
+            {
+                auto & intersection = intersections[index];
+
+                if (intersection.intersectable)
+                {
+                    intersection.point  = rays[index].point_at (intersection.t);
+                    intersection.normal = intersection.intersectable->normal_at (intersection.point);
+                }
+            }
+        }
+    }
+
+    void Linear_Space::refit ()
+    {
+        if (current_version)
+        {
+            compute_bounding_box (*current_version);
+        }
+    }
+
+    void Linear_Space::start_rebuild ()
+    {
+        // La lista de primitivas se copia en este hilo porque los modelos pueden seguir
+        // modificándose. El resto de la construcción se hace en segundo plano.
+
+        pending_version = std::async (std::launch::async, build_version, gather_intersectables ());
+    }
+
+    bool Linear_Space::finish_rebuild ()
+    {
+        if (pending_version.valid () && pending_version.wait_for (std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            current_version = pending_version.get ();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    Linear_Space::Intersectable_Lists Linear_Space::gather_intersectables () const
+    {
+        Intersectable_Lists models;
+
+        for (auto & model : scene)
+        {
+            if (not model.intersectables.empty ())
+            {
+                models.push_back (model.intersectables);
+            }
+        }
+
+        return models;
+    }
+
+    Linear_Space::Version_Ptr Linear_Space::build_version (Intersectable_Lists models)
+    {
+        auto version = std::make_unique< Version > ();
+
+        for (auto & intersectables : models)
+        {
+            Bounded_Model bounded_model;
+
+            for (auto & intersectable : intersectables)
+            {
+                if (intersectable->is_bounded ())
+                {
+                    bounded_model.intersectables.push_back (intersectable);
+                }
+                else
+                {
+                    version->unbounded_intersectables.push_back (intersectable);
+                }
+            }
+
+            // Los planos no tienen caja: un modelo que solo tiene planos no queda en la lista
+
+            if (not bounded_model.intersectables.empty ())
+            {
+                version->bounded_count += bounded_model.intersectables.size ();
+                version->bounded_models.push_back (std::move (bounded_model));
+            }
+        }
+
+        compute_bounding_box (*version);
+
+        return version;
+    }
+
+    void Linear_Space::compute_bounding_box (Version & version)
+    {
+        version.bounding_box = Bounding_Box();
+
+        for (auto & model : version.bounded_models)
+        {
+            model.bounding_box = Bounding_Box();
+
+            for (auto & intersectable : model.intersectables)
+            {
+                model.bounding_box.extend (intersectable->get_bounding_box ());
+            }
+
+            version.bounding_box.extend (model.bounding_box);
+        }
+    }
+
+    // Prueba las primitivas de cada modelo con los rayos del lote. Si hay más de un modelo, los
+    // rayos que no atraviesan la caja de un modelo con bastantes primitivas no se prueban con
+    // ellas.
+
+    void Linear_Space::intersect_models
+    (
+        const Version           & version,
+        std::span< const Ray >    rays,
+        std::span< Intersection > intersections,
+        unsigned                  flags,
+        float                     min_t
+    )
+    {
+        thread_local Culling_Buffers buffers;
+
+        bool several_models = version.bounded_models.size () > 1;
+
+        for (auto & model : version.bounded_models)
+        {
+            auto intersect = [&](std::span< const Ray > model_rays, std::span< Intersection > model_intersections)
+            {
+                intersect_list (model.intersectables, model_rays, model_intersections, flags, min_t);
+            };
+
+            if (several_models && model.intersectables.size () >= box_culling_threshold)
+            {
+                cull_by_box (model.bounding_box, rays, intersections, flags, min_t, buffers, intersect);
+            }
+            else
+            {
+                intersect (rays, intersections);
+            }
+        }
+    }
+
+    // Prueba las primitivas de la lista con los rayos del lote. Con ANY_HIT no se vuelven a probar
+    // los rayos que ya han chocado con algo: cuando son bastantes se apartan del lote (que se
+    // copia la primera vez) y, si lo son todos, se termina sin probar las primitivas que quedan.
+
+    void Linear_Space::intersect_list
+    (
+        const Intersectable_List & intersectables,
+        std::span< const Ray >     rays,
+        std::span< Intersection >  intersections,
+        unsigned                   flags,
+        float                      min_t
+    )
+    {
+        if (not (flags & ANY_HIT))
+        {
+            for (auto & intersectable : intersectables)
+            {
+                intersectable->intersect (rays, min_t, intersections);
+            }
+
+            return;
+        }
+
+        thread_local Culling_Buffers buffers;
+
+        std::span< const Ray    > active_rays          = rays;
+        std::span< Intersection > active_intersections = intersections;
+        bool                      compacted            = false;
+
+        auto compact = [&] ()
+        {
+            if (not compacted)
+            {
+                buffers.rays         .clear ();
+                buffers.intersections.clear ();
+                buffers.lanes        .clear ();
+
+                for (uint32_t lane = 0, count = uint32_t(rays.size ()); lane < count; ++lane)
+                {
+                    if (intersections[lane].intersectable) continue;
+
+                    buffers.rays         .push_back (rays[lane]);
+                    buffers.intersections.push_back (intersections[lane]);
+                    buffers.lanes        .push_back (lane);
+                }
+
+                compacted = true;
+            }
+            else
+            {
+                // Los que se apartan ya tienen su resultado definitivo
+
+                size_t kept = 0;
+
+                for (size_t index = 0; index < buffers.lanes.size (); ++index)
+                {
+                    if (buffers.intersections[index].intersectable)
+                    {
+                        intersections[buffers.lanes[index]] = buffers.intersections[index];
+                    }
+                    else
+                    {
+                        buffers.rays         [kept] = buffers.rays         [index];
+                        buffers.intersections[kept] = buffers.intersections[index];
+                        buffers.lanes        [kept] = buffers.lanes        [index];
+                        ++kept;
+                    }
+                }
+
+                buffers.rays         .resize (kept);
+                buffers.intersections.resize (kept);
+                buffers.lanes        .resize (kept);
+            }
+
+            active_rays          = buffers.rays;
+            active_intersections = buffers.intersections;
+        };
+
+        for (auto & intersectable : intersectables)
+        {
+            size_t resolved = size_t
+            (
+                std::count_if
+                (
+                    active_intersections.begin (), active_intersections.end (),
+                    [](const Intersection & intersection) { return intersection.intersectable != nullptr; }
+                )
+            );
+
+            if (resolved == active_intersections.size ()) break;
+
+            if (resolved * resolved_fraction_divisor >= active_intersections.size ()) compact ();
+
+            intersectable->intersect (active_rays, min_t, active_intersections);
+        }
+
+        if (compacted)
+        {
+            for (size_t index = 0; index < buffers.lanes.size (); ++index)
+            {
+                intersections[buffers.lanes[index]] = buffers.intersections[index];
+            }
+        }
+    }
+
+    // Llama a function con los rayos del lote que atraviesan la caja antes de su intersección más
+    // cercana hasta ahora (y que no están ya resueltos si basta con cualquier intersección). Solo
+    // se compacta el lote cuando hay rayos que descartar.
+
+    template< class FUNCTION >
+    void Linear_Space::cull_by_box
+    (
+        const Bounding_Box      & bounding_box,
+        std::span< const Ray >    rays,
+        std::span< Intersection > intersections,
+        unsigned                  flags,
+        float                     min_t,
+        Culling_Buffers         & buffers,
+        FUNCTION               && function
+    )
+    {
+        buffers.lanes.clear ();
+
+        for (uint32_t lane = 0, count = uint32_t(rays.size ()); lane < count; ++lane)
+        {
+            if ((flags & ANY_HIT) && intersections[lane].intersectable) continue;
+
+            if (bounding_box.intersects (rays[lane], min_t, intersections[lane].t))
+            {
+                buffers.lanes.push_back (lane);
+            }
+        }
+
+        if (buffers.lanes.size () == rays.size ())
+        {
+            function (rays, intersections);
+        }
+        else
+        if (not buffers.lanes.empty ())
+        {
+            buffers.rays         .clear ();
+            buffers.intersections.clear ();
+
+            for (auto lane : buffers.lanes)
+            {
+                buffers.rays         .push_back (rays[lane]);
+                buffers.intersections.push_back (intersections[lane]);
+            }
+
+            function (std::span< const Ray >(buffers.rays), std::span< Intersection >(buffers.intersections));
+
+            for (size_t index = 0; index < buffers.lanes.size (); ++index)
+            {
+                intersections[buffers.lanes[index]] = buffers.intersections[index];
+            }
+        }
+    }
+
 }
@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numbers>
+
+#include <raytracer/Path_Guide.hpp>
+
+namespace udit::raytracer
+{
+
+    namespace
+    {
+
+        constexpr float pi = std::numbers::pi_v< float >;
+
+    }
+
+    Path_Guide::Path_Guide(float cell_size, unsigned capacity_bits)
+    :
+        grid(cell_size, capacity_bits)
+    {
+        clear ();
+    }
+
+    Path_Guide::Cell * Path_Guide::find (const Vector3 & point, const Vector3 & normal)
+    {
+        return grid.find (grid.key_of (point, normal));
+    }
+
+    const Path_Guide::Cell * Path_Guide::find_ready (const Vector3 & point, const Vector3 & normal) const
+    {
+        auto cell = grid.find_existing (grid.key_of (point, normal));
+
+        return cell && cell->ready ? cell : nullptr;
+    }
+
+    void Path_Guide::clear ()
+    {
+        std::for_each (std::execution::par, grid.begin (), grid.end (), [](Cell & cell)
+        {
+            cell.key         .store (0, std::memory_order_relaxed);
+            cell.sample_count.store (0, std::memory_order_relaxed);
+
+            for (auto & value : cell.training) value.store (0.f, std::memory_order_relaxed);
+
+            cell.ready = false;
+        });
+    }
+
+    // Lo aprendido no se descarta entre fotogramas: la estimación de cada celda mejora con el
+    // tiempo mientras la escena no cambie.
+
+    void Path_Guide::update ()
+    {
+        std::for_each (std::execution::par, grid.begin (), grid.end (), [](Cell & cell)
+        {
+            if (cell.sample_count.load (std::memory_order_relaxed) < training_samples) return;
+
+            float total = 0.f;
+
+            for (auto & value : cell.training) total += value.load (std::memory_order_relaxed);
+
+            if (not (total > 0.f)) return;
+
+            cell.cdf[0] = 0.f;
+
+            for (unsigned bin = 0; bin < bins; ++bin)
+            {
+                float probability = (1.f - uniform_fraction) * cell.training[bin].load (std::memory_order_relaxed) / total
+                                  +        uniform_fraction  / bins;
+
+                cell.cdf[bin + 1] = cell.cdf[bin] + probability;
+            }
+
+            cell.cdf[bins] = 1.f;
+            cell.ready     = true;
+        });
+    }
+
+    namespace
+    {
+
+        // Hemisferio de la celda: eje dominante de la normal, su signo y los otros dos ejes
+
+        struct Hemisphere
+        {
+            unsigned axis;
+            unsigned tangent;
+            unsigned bitangent;
+            float    sign;
+
+            Hemisphere(const Vector3 & normal)
+            {
+                axis      = unsigned(Hashed_Grid< Path_Guide::Cell, Path_Guide::maximum_probes >::classify_normal (normal) / 2);
+                sign      = normal[axis] < 0.f ? -1.f : 1.f;
+                tangent   = (axis + 1) % 3;
+                bitangent = (axis + 2) % 3;
+            }
+        };
+
+        // Bin de la dirección o bins si cae fuera del hemisferio. cosine es el coseno con el eje.
+
+        unsigned bin_of (const Hemisphere & hemisphere, const Vector3 & direction, float & cosine)
+        {
+            cosine = hemisphere.sign * direction[hemisphere.axis];
+
+            if (cosine <= 0.f) return Path_Guide::bins;
+
+            float    x      = direction[hemisphere.tangent  ];
+            float    y      = direction[hemisphere.bitangent];
+            unsigned ring   = std::min (unsigned((x * x + y * y) * Path_Guide::rings), Path_Guide::rings - 1);
+            unsigned sector = std::min (unsigned((std::atan2 (y, x) + pi) / (2.f * pi) * Path_Guide::sectors), Path_Guide::sectors - 1);
+
+            return ring * Path_Guide::sectors + sector;
+        }
+
+    }
+
+    void Path_Guide::add_sample (Cell & cell, const Vector3 & normal, const Vector3 & direction, float value)
+    {
+        float    cosine;
+        unsigned bin = bin_of (Hemisphere(normal), direction, cosine);
+
+        if (bin < bins)
+        {
+            cell.training[bin].fetch_add (value, std::memory_order_relaxed);
+            cell.sample_count .fetch_add (1,     std::memory_order_relaxed);
+        }
+    }
+
+    // Se elige el bin con la CDF y después un punto uniforme del trozo de disco que le corresponde,
+    // que al subirlo al hemisferio tiene densidad proporcional al coseno con el eje.
+
+    Vector3 Path_Guide::sample (const Cell & cell, const Vector3 & normal, const Vector2 & random, float & pdf)
+    {
+        auto     upper = std::upper_bound (cell.cdf.begin () + 1, cell.cdf.end (), random.x);
+        unsigned bin   = std::min (unsigned(upper - cell.cdf.begin ()) - 1, bins - 1);
+        float    width = cell.cdf[bin + 1] - cell.cdf[bin];
+        float    local = width > 0.f ? std::clamp ((random.x - cell.cdf[bin]) / width, 0.f, .99999994f) : .5f;
+
+        Hemisphere hemisphere(normal);
+
+        float radius_squared = (float(bin / sectors) + local   ) / rings;
+        float angle          = (float(bin % sectors) + random.y) / sectors * 2.f * pi - pi;
+        float radius         = std::sqrt (radius_squared);
+        float cosine         = std::sqrt (std::max (0.f, 1.f - radius_squared));
+
+        Vector3 direction;
+
+        direction[hemisphere.axis     ] = hemisphere.sign * cosine;
+        direction[hemisphere.tangent  ] = radius * std::cos (angle);
+        direction[hemisphere.bitangent] = radius * std::sin (angle);
+
+        pdf = width * bins * cosine / pi;
+
+        return direction;
+    }
+
+    float Path_Guide::pdf (const Cell & cell, const Vector3 & normal, const Vector3 & direction)
+    {
+        float    cosine;
+        unsigned bin = bin_of (Hemisphere(normal), direction, cosine);
+
+        return bin < bins ? (cell.cdf[bin + 1] - cell.cdf[bin]) * bins * cosine / pi : 0.f;
+    }
+
+}
@@ -5,52 +5,529 @@
  * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
  */
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <locale>
 #include <execution>
 #include <numeric>
+#include <thread>
+#include <type_traits>
 
+#include <raytracer/Blue_Noise_Sampler.hpp>
+#include <raytracer/Diffuse_Material.hpp>
+#include <raytracer/Environment_Map.hpp>
 #include <raytracer/Intersectable.hpp>
 #include <raytracer/Intersection.hpp>
+#include <raytracer/Linear_Space.hpp>
 #include <raytracer/Material.hpp>
+#include <raytracer/Material_Set.hpp>
+#include <raytracer/Metallic_Material.hpp>
 #include <raytracer/Path_Tracer.hpp>
+#include <raytracer/Random_Sampler.hpp>
 #include <raytracer/Sky_Environment.hpp>
+#include <raytracer/Skydome.hpp>
+#include <raytracer/Sobol_Sampler.hpp>
+#include <raytracer/Stratified_Sampler.hpp>
 
 namespace udit::raytracer
 {
 
+    // Llama a function con el tipo de sampler que corresponde al patrón de muestreo elegido
+
+    template< class FUNCTION >
+    void Path_Tracer::dispatch_sampler (FUNCTION && function)
+    {
+        switch (sampling_pattern)
+        {
+            case WHITE_NOISE: function (std::type_identity< Random_Sampler     >{ }); break;
+            case STRATIFIED:  function (std::type_identity< Stratified_Sampler >{ }); break;
+            case SOBOL:       function (std::type_identity< Sobol_Sampler      >{ }); break;
+            case BLUE_NOISE:  function (std::type_identity< Blue_Noise_Sampler >{ }); break;
+        }
+    }
+
+    // Llama a function con la especialización del trazado que corresponde a las clases concretas
+    // de la estructura espacial y del cielo, además de con ambos ya convertidos. Las combinaciones
+    // que no están aquí usan la especialización genérica, que funciona igual pero con llamadas
+    // virtuales.
+
+    template< class FUNCTION >
+    void Path_Tracer::dispatch_scene (Spatial_Data_Structure & space, FUNCTION && function)
+    {
+        using Materials = Material_Set< Diffuse_Material, Metallic_Material >;
+
+        auto sky          = space.get_scene ().get_sky_environment ();
+        auto linear_space = dynamic_cast< Linear_Space * >(&space);
+
+        assert(sky != nullptr);
+
+        if (linear_space)
+        {
+            if (auto skydome = dynamic_cast< Skydome * >(sky))
+            {
+                function (std::type_identity< Static_Scene< Linear_Space, Skydome, Materials > >{ }, *linear_space, *skydome);
+                return;
+            }
+
+            if (auto environment_map = dynamic_cast< Environment_Map * >(sky))
+            {
+                function (std::type_identity< Static_Scene< Linear_Space, Environment_Map, Materials > >{ }, *linear_space, *environment_map);
+                return;
+            }
+        }
+
+        function (std::type_identity< Static_Scene< Spatial_Data_Structure, Sky_Environment, Materials > >{ }, space, *sky);
+    }
+
+    // Los píxeles se reparten en grupos de wavefront_size que se procesan en paralelo. Como los
+    // búferes están organizados por baldosas, cada grupo es una baldosa de la imagen y sus rayos
+    // primarios salen de píxeles vecinos.
+
     void Path_Tracer::sample_primary_rays_stage (Frame_Data & frame_data)
     {
-        auto & sky_environment        = *frame_data.space.get_scene ().get_sky_environment ();
-        auto & spatial_data_structure =  frame_data.space;
-        auto   number_of_iterations   =  frame_data.number_of_iterations;
+        if (frame_data.deadline)
+        {
+            sample_until_deadline (frame_data);
+            return;
+        }
+
+        frame_data.interleaved = interleaving.pattern != NO_INTERLEAVING && frame_data.camera_changed;
+
+        std::vector< unsigned > groups(get_group_count ());
+        std::iota (groups.begin (), groups.end (), 0);
+
+        dispatch_scene (frame_data.space, [&]< class SCENE >(std::type_identity< SCENE >, auto & spatial_data_structure, auto & sky_environment)
+        {
+            dispatch_sampler ([&]< class SAMPLER >(std::type_identity< SAMPLER >)
+            {
+                std::for_each (std::execution::par, groups.begin (), groups.end (), [&](unsigned group)
+                    {
+                        sample_group< SAMPLER, SCENE > (frame_data, spatial_data_structure, sky_environment, group);
+                    });
+            });
+        });
+    }
+
+    // Traza las muestras de un grupo de píxeles en un fotograma de trace(). Al entrelazar solo se
+    // trazan los píxeles de la baldosa que tocan en este fotograma.
+
+    template< class SAMPLER, class SCENE >
+    void Path_Tracer::sample_group
+    (
+        const Frame_Data                & frame_data,
+        typename SCENE::Space           & spatial_data_structure,
+        const typename SCENE::Sky       & sky_environment,
+        unsigned                          group
+    )
+    {
+        if (check_cancellation ()) return;
+
+        unsigned number_of_pixels = primary_rays.size ();
+        unsigned first_pixel      = group * wavefront_size;
+        unsigned lane_count       = std::min (wavefront_size, number_of_pixels - first_pixel);
+
+        std::array< unsigned, wavefront_size > pixels;
+
+        if (not frame_data.interleaved)
+        {
+            std::iota (pixels.begin (), pixels.begin () + lane_count, first_pixel);
+
+            trace_group< SAMPLER, SCENE >
+            (
+                spatial_data_structure,
+                sky_environment,
+                std::span(pixels.data (), lane_count),
+                get_first_sample (),
+                std::span(framebuffer.data () + first_pixel, lane_count),
+                frame_data.number_of_iterations
+            );
+
+            return;
+        }
+
+        // Los píxeles elegidos no son contiguos: su acumulación se trae y se devuelve
+
+        std::array< Accumulated_Color, wavefront_size > accumulation;
+
+        unsigned traced_count = 0;
+
+        for (unsigned pixel = first_pixel; pixel < first_pixel + lane_count; ++pixel)
+        {
+            unsigned x, y;
 
-        // Creamos un vector de índices que representa cada píxel/rayo
-        std::vector<size_t> indices(primary_rays.size());
-        std::iota(indices.begin(), indices.end(), 0); // Rellenamos con 0, 1, 2, ...
+            primary_rays.coordinates_of (pixel, x, y);
 
-        // Procesamos todos los píxeles de forma paralela con ejecución en paralelo
-        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t index)
+            if (is_interleaved_pixel (x, y))
             {
-                // Para cada rayo, lanzamos 'number_of_iterations' muestras (acumuladas)
-                for (unsigned iterations = number_of_iterations;iterations > 0; --iterations)
+                accumulation[traced_count  ] = framebuffer[pixel];
+                pixels      [traced_count++] = pixel;
+            }
+        }
+
+        trace_group< SAMPLER, SCENE >
+        (
+            spatial_data_structure,
+            sky_environment,
+            std::span(pixels.data (), traced_count),
+            get_first_sample (),
+            std::span(accumulation.data (), traced_count),
+            frame_data.number_of_iterations
+        );
+
+        for (unsigned lane = 0; lane < traced_count; ++lane)
+        {
+            framebuffer[pixels[lane]] = accumulation[lane];
+        }
+    }
+
+    void Path_Tracer::trace_views (Spatial_Data_Structure & space, std::span< const View > views)
+    {
+        struct Work
+        {
+            unsigned view;
+            unsigned group;
+        };
+
+        std::vector< Frame_Data > frames;
+        std::vector< Work       > work;
+
+        frames.reserve (views.size ());
+
+        for (unsigned index = 0; index < unsigned(views.size ()); ++index)
+        {
+            auto & view       = views[index];
+            auto & tracer     = *view.tracer;
+            auto & frame_data = frames.emplace_back (Frame_Data{ space, view.viewport_width, view.viewport_height, view.number_of_iterations });
+
+            tracer.begin_frame (frame_data);
+
+            frame_data.interleaved = tracer.interleaving.pattern != NO_INTERLEAVING && frame_data.camera_changed;
+
+            for (unsigned group = 0, count = tracer.get_group_count (); group < count; ++group)
+            {
+                work.push_back (Work{ index, group });
+            }
+        }
+
+        std::for_each (std::execution::par, work.begin (), work.end (), [&](const Work & item)
+            {
+                auto & tracer = *views[item.view].tracer;
+
+                tracer.dispatch_scene (space, [&]< class SCENE >(std::type_identity< SCENE >, auto & spatial_data_structure, auto & sky_environment)
                 {
-                    // Trazamos el rayo primario y acumulamos el color resultante
-                    framebuffer[(unsigned int)index] += trace_ray(primary_rays[(unsigned int)index], spatial_data_structure, sky_environment, 0);
+                    tracer.dispatch_sampler ([&]< class SAMPLER >(std::type_identity< SAMPLER >)
+                    {
+                        tracer.template sample_group< SAMPLER, SCENE > (frames[item.view], spatial_data_structure, sky_environment, item.group);
+                    });
+                });
+            });
+
+        for (unsigned index = 0; index < unsigned(views.size ()); ++index)
+        {
+            views[index].tracer->end_frame (frames[index]);
+        }
+    }
+
+    // Traza lotes de grupos de píxeles, una muestra por píxel, hasta llegar al plazo. El tamaño de
+    // cada lote se ajusta con el tiempo medio que han costado los anteriores para que el último
+    // termine cerca del plazo sin pasarse mucho. Un lote tiene al menos un grupo por hilo.
+
+    void Path_Tracer::sample_until_deadline (Frame_Data & frame_data)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        auto & report                 =  frame_data.report;
+        auto   number_of_pixels       =  primary_rays.size ();
+        auto   number_of_groups       = (number_of_pixels + wavefront_size - 1) / wavefront_size;
+        auto   concurrency            =  std::max (1u, std::thread::hardware_concurrency ());
+
+        if (number_of_groups == 0) return;
+
+        if (budget.next_group >= number_of_groups) budget.next_group = 0;
+
+        std::vector< unsigned > groups;
+        uint64_t                traced_groups = 0;
+
+        dispatch_scene (frame_data.space, [&]< class SCENE >(std::type_identity< SCENE >, auto & spatial_data_structure, auto & sky_environment)
+        {
+            dispatch_sampler ([&]< class SAMPLER >(std::type_identity< SAMPLER >)
+            {
+                do
+                {
+                    float    remaining  = std::chrono::duration< float >(*frame_data.deadline - Clock::now ()).count ();
+                    unsigned batch_size = concurrency;
+
+                    if (budget.seconds_per_group > 0.f && remaining > 0.f)
+                    {
+                        batch_size = unsigned(std::min (float(number_of_groups), remaining / budget.seconds_per_group * float(concurrency)));
+                        batch_size = std::max (batch_size, concurrency);
+                    }
+
+                    batch_size = std::min (batch_size, number_of_groups - budget.next_group);
+
+                    groups.resize (batch_size);
+                    std::iota (groups.begin (), groups.end (), budget.next_group);
+
+                    Timer timer;
+
+                    std::for_each (std::execution::par, groups.begin (), groups.end (), [&](unsigned group)
+                        {
+                            if (check_cancellation ()) return;
+
+                            unsigned first_pixel = group * wavefront_size;
+                            unsigned lane_count  = std::min (wavefront_size, number_of_pixels - first_pixel);
+
+                            std::array< unsigned, wavefront_size > pixels;
+                            std::iota (pixels.begin (), pixels.begin () + lane_count, first_pixel);
+
+                            trace_group< SAMPLER, SCENE >
+                            (
+                                spatial_data_structure,
+                                sky_environment,
+                                std::span(pixels.data (), lane_count),
+                                get_first_sample (),
+                                std::span(framebuffer.data () + first_pixel, lane_count),
+                                1
+                            );
+                        });
 
-                    // Contamos el número de rayos emitidos por píxel (para promediar después)
-                    ray_counters[(unsigned int)index] += 1;
+                    // Media móvil para seguir los cambios de la escena sin dar saltos
+
+                    float seconds_per_group = timer.get_elapsed< Seconds > () * float(std::min (concurrency, batch_size)) / float(batch_size);
+
+                    budget.seconds_per_group = budget.seconds_per_group > 0.f
+                                             ? budget.seconds_per_group * .75f + seconds_per_group * .25f
+                                             : seconds_per_group;
+
+                    unsigned last_group = budget.next_group + batch_size;
+
+                    report.traced_samples += std::min (last_group * wavefront_size, number_of_pixels) - budget.next_group * wavefront_size;
+
+                    traced_groups     += batch_size;
+                    budget.next_group  = last_group;
+
+                    if (budget.next_group == number_of_groups)
+                    {
+                        budget.next_group = 0;
+
+                        report.completed_passes++;
+                    }
                 }
+                while (Clock::now () < *frame_data.deadline && not check_cancellation ());
             });
-        
-        /*for (unsigned index = 0, end = primary_rays.size (); index < end; ++index)
+        });
+
+        report.minimum_samples = unsigned(traced_groups / number_of_groups);
+        report.maximum_samples = unsigned(traced_groups / number_of_groups + (traced_groups % number_of_groups != 0));
+    }
+
+    void Path_Tracer::trace_tile
+    (
+        Spatial_Data_Structure    & space,
+        unsigned                    viewport_width,
+        unsigned                    viewport_height,
+        const Tile                & tile,
+        uint32_t                    first_sample,
+        unsigned                    number_of_samples,
+        Buffer< Accumulated_Color > & tile_accumulation
+    )
+    {
+        assert(tile.x + tile.width <= viewport_width && tile.y + tile.height <= viewport_height);
+
+        // Los rayos primarios solo se recalculan si han cambiado la cámara o el viewport
+
+        auto  camera = get_camera (space.get_scene ());
+
+        assert(camera != nullptr);
+
+        auto & matrix = camera->transform.get_matrix ();
+
+        if (primary_rays.get_width () != viewport_width || primary_rays.get_height () != viewport_height
+        ||  matrix != tile_camera.matrix || camera->get_focal_length () != tile_camera.focal_length)
+        {
+            primary_rays.resize (viewport_width, viewport_height);
+
+            camera->calculate (primary_rays);
+
+            update_pixel_spread ();
+
+            tile_camera.matrix       = matrix;
+            tile_camera.focal_length = camera->get_focal_length ();
+        }
+
+        space.update ();
+
+        tile_accumulation.set_layout (Buffer_Layout::ROW_MAJOR);
+        tile_accumulation.resize     (tile.width, tile.height);
+        tile_accumulation.clear      (Accumulated_Color());
+
+        unsigned number_of_pixels = tile.width * tile.height;
+
+        std::vector< unsigned > groups((number_of_pixels + wavefront_size - 1) / wavefront_size);
+        std::iota (groups.begin (), groups.end (), 0);
+
+        dispatch_scene (space, [&]< class SCENE >(std::type_identity< SCENE >, auto & spatial_data_structure, auto & sky_environment)
         {
-            for (unsigned iterations = number_of_iterations; iterations > 0; --iterations)
+            dispatch_sampler ([&]< class SAMPLER >(std::type_identity< SAMPLER >)
             {
-                framebuffer [index] += trace_ray (primary_rays[index], spatial_data_structure, sky_environment, 0);
-                ray_counters[index] += 1;
+                std::for_each (std::execution::par, groups.begin (), groups.end (), [&](unsigned group)
+                    {
+                        unsigned first_pixel = group * wavefront_size;
+                        unsigned lane_count  = std::min (wavefront_size, number_of_pixels - first_pixel);
+
+                        std::array< unsigned, wavefront_size > pixels;
+
+                        for (unsigned lane = 0; lane < lane_count; ++lane)
+                        {
+                            unsigned x = tile.x + (first_pixel + lane) % tile.width;
+                            unsigned y = tile.y + (first_pixel + lane) / tile.width;
+
+                            pixels[lane] = primary_rays.offset_of (x, y);
+                        }
+
+                        trace_group< SAMPLER, SCENE >
+                        (
+                            spatial_data_structure,
+                            sky_environment,
+                            std::span(pixels.data (), lane_count),
+                            first_sample,
+                            std::span(tile_accumulation.data () + first_pixel, lane_count),
+                            number_of_samples
+                        );
+                    });
+            });
+        });
+    }
+
+    // Traza number_of_iterations muestras de cada píxel del grupo (posiciones en primary_rays) y
+    // las suma a accumulation. La muestra que toca a cada píxel es sample_offset más las que ya
+    // tiene acumuladas. Dentro del grupo los caminos avanzan rebote a rebote, de forma que cada
+    // rebote es un único lote de rayos para la estructura espacial.
+
+    template< class SAMPLER, class SCENE >
+    void Path_Tracer::trace_group
+    (
+        typename SCENE::Space           & spatial_data_structure,
+        const typename SCENE::Sky       & sky_environment,
+        std::span< const unsigned >       pixels,
+        uint32_t                          sample_offset,
+        std::span< Accumulated_Color >    accumulation,
+        unsigned                          number_of_iterations
+    )
+    {
+        thread_local Wavefront wavefront;
+
+        unsigned lane_count = unsigned(pixels.size ());
+
+        // Cada píxel tiene su propio sampler: no se comparte estado entre hilos
+        std::array< SAMPLER,  wavefront_size > samplers;
+        std::array< unsigned, wavefront_size > x, y;
+
+        for (unsigned lane = 0; lane < lane_count; ++lane)
+        {
+            primary_rays.coordinates_of (pixels[lane], x[lane], y[lane]);
+        }
+
+        for (unsigned iteration = 0; iteration < number_of_iterations; ++iteration)
+        {
+            if (iteration > 0 && check_cancellation ()) break;
+
+            wavefront.paths.clear ();
+            wavefront.rays .clear ();
+            wavefront.radiance.assign (lane_count, Color(0, 0, 0));
+
+            for (unsigned lane = 0; lane < lane_count; ++lane)
+            {
+                samplers[lane].start (x[lane], y[lane], sample_offset + uint32_t(accumulation[lane].get_sample_count ()));
+
+                wavefront.paths.push_back (Path{ Color(1, 1, 1), 0.f, lane, 0.f, pixel_spread });
+                wavefront.rays .push_back (primary_rays[pixels[lane]]);
+            }
+
+            trace_paths< SAMPLER, SCENE > (wavefront, spatial_data_structure, sky_environment, std::span(samplers.data (), lane_count));
+
+            for (unsigned lane = 0; lane < lane_count; ++lane)
+            {
+                accumulation[lane].add (wavefront.radiance[lane]);
             }
-        }*/
+        }
+    }
+
+    void Path_Tracer::checkpoint_stage (Frame_Data & frame_data)
+    {
+        if (not checkpoint.file.is_open ()) return;
+
+        // La cabecera se actualiza en cada fotograma; el volcado a disco se espacia
+
+        auto   camera = get_camera (frame_data.space.get_scene ());
+        auto & header = checkpoint.file.get_header ();
+
+        checkpoint.file.set_camera (camera->transform.get_matrix (), camera->get_focal_length ());
+
+        header.total_samples = 0;
+
+        for (unsigned offset = 0, size = framebuffer.size (); offset < size; ++offset)
+        {
+            header.total_samples += uint64_t(framebuffer[offset].get_sample_count ());
+        }
+
+        if (checkpoint.flush_timer.get_elapsed< Seconds > () > checkpoint_flush_period)
+        {
+            checkpoint.file.flush ();
+            checkpoint.flush_timer.reset ();
+        }
+    }
+
+    void Path_Tracer::open_checkpoint ()
+    {
+        unsigned width  = framebuffer.get_width  ();
+        unsigned height = framebuffer.get_height ();
+
+        bool resumed = checkpoint.file.open (checkpoint.path, width, height, framebuffer.get_layout (), checkpoint.scene_hash, sample_offset);
+
+        if (not checkpoint.file.is_open ())
+        {
+            checkpoint.path.clear ();
+            return;
+        }
+
+        // Si no había nada que continuar, el fichero se queda con lo acumulado hasta ahora
+
+        if (not resumed)
+        {
+            std::copy_n (framebuffer.data (), framebuffer.size (), checkpoint.file.get_pixels ());
+        }
+
+        framebuffer.attach (width, height, checkpoint.file.get_pixels ());
+
+        checkpoint.resuming = resumed;
+        checkpoint.flush_timer.reset ();
+    }
+
+    void Path_Tracer::disable_checkpoint ()
+    {
+        if (checkpoint.file.is_open () and not framebuffer.owns_elements ())
+        {
+            // El framebuffer vuelve a memoria propia conservando lo acumulado
+
+            Buffer< Accumulated_Color > copy(framebuffer);
+
+            framebuffer.swap (copy);
+        }
+
+        close_checkpoint ();
+    }
+
+    void Path_Tracer::close_checkpoint ()
+    {
+        checkpoint.file.close ();
+
+        checkpoint.path.clear ();
+
+        checkpoint.resuming = false;
     }
 
     void Path_Tracer::end_benchmark_stage (Frame_Data & )
@@ -67,39 +544,519 @@ namespace udit::raytracer
         }
     }
 
-    Color Path_Tracer::trace_ray
+    namespace
+    {
+
+        float luminance (const Color & color)
+        {
+            return std::max (0.f, 0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b);
+        }
+
+        // Devuelve primero un par de valores ya sacados del sampler y después sigue con él
+
+        class Replayed_Sampler : public Sampler
+        {
+            Sampler & sampler;
+            Vector2   first_pair;
+            bool      replayed;
+
+        public:
+
+            Replayed_Sampler(Sampler & given_sampler, const Vector2 & given_first_pair)
+            :
+                sampler   (given_sampler),
+                first_pair(given_first_pair),
+                replayed  (false)
+            {
+            }
+
+            void start (unsigned x, unsigned y, uint32_t sample_index) override
+            {
+                sampler.start (x, y, sample_index);
+            }
+
+            float get_1d () override
+            {
+                return sampler.get_1d ();
+            }
+
+            Vector2 get_2d () override
+            {
+                if (replayed) return sampler.get_2d ();
+
+                replayed = true;
+
+                return first_pair;
+            }
+        };
+
+        // Heurística de la potencia (beta = 2) para combinar dos estrategias de muestreo (MIS)
+
+        float power_heuristic (float pdf, float other_pdf)
+        {
+            float a = pdf * pdf;
+            float b = other_pdf * other_pdf;
+
+            return a + b > 0.f ? a / (a + b) : 0.f;
+        }
+
+    }
+
+    // Avanza todos los caminos del lote hasta que escapan, se absorben o llegan al límite de
+    // rebotes, acumulando en wavefront.radiance la radiancia de cada uno.
+
+    template< class SAMPLER, class SCENE >
+    void Path_Tracer::trace_paths
     (
-        const Ray              & ray,
-        Spatial_Data_Structure & spatial_data_structure,
-        const Sky_Environment  & sky_environment,
-        unsigned                 depth
+        Wavefront                 & wavefront,
+        typename SCENE::Space     & spatial_data_structure,
+        const typename SCENE::Sky & sky_environment,
+        std::span< SAMPLER >        samplers
     )
     {
-        benchmark.emitted_ray_count++;
+        using Materials = typename SCENE::Materials;
+
+        bool sample_light = sky_environment.is_importance_sampled ();
 
-        Intersection intersection;
+        if (radiance_cache)
+        {
+            wavefront.cache_records.assign (samplers.size (), Cache_Record{});
+        }
 
-        // hacer que min_t sea >= 1 para los rayos primarios...
+        wavefront.guide_records.clear ();
 
-        if (spatial_data_structure.traverse (ray, 0.0001f, 10000.f, intersection))
+        for (unsigned depth = 0; not wavefront.paths.empty (); ++depth)
         {
-            Ray   scattered_ray;
-            Color attenuation;
+            size_t first_guide_record = wavefront.guide_records.size ();
+
+            auto count = wavefront.rays.size ();
+
+            benchmark.emitted_ray_count += count;
 
-            if (intersection.intersectable->material->scatter (ray, scattered_ray, intersection, attenuation))
+            // hacer que min_t sea >= 1 para los rayos primarios...
+
+            wavefront.intersections.resize (count);
+
+            spatial_data_structure.traverse (wavefront.rays, wavefront.intersections, Spatial_Data_Structure::CLOSEST_HIT, 0.0001f, 10000.f);
+
+            // Después del primer rebote los materiales que se encuentran están mezclados: se
+            // sombrean agrupados para que cada uno reutilice su código y sus datos, si lo medido
+            // dice que compensa.
+
+            bool  measured = material_sorting && depth > 0;
+            bool  sorting  = measured && wavefront.sorter.wants_material_sorting (count);
+            Timer shading_timer;
+
+            bool grouped = sorting && wavefront.sorter.sort_by_material (wavefront.intersections, wavefront.order);
+
+            wavefront.next_paths  .clear ();
+            wavefront.next_rays   .clear ();
+            wavefront.shadow_rays .clear ();
+            wavefront.shadow_radiance.clear ();
+            wavefront.shadow_lanes.clear ();
+
+            for (size_t position = 0; position < count; ++position)
             {
-                if (depth < recursion_limit)
+                size_t               index        = grouped ? wavefront.order[position] : position;
+                const Ray          & ray          = wavefront.rays         [index];
+                Intersection       & intersection = wavefront.intersections[index];
+                const Path         & path         = wavefront.paths        [index];
+                SAMPLER            & sampler      = samplers[path.lane];
+
+                if (not intersection.intersectable)
                 {
-                    return attenuation * trace_ray (scattered_ray, spatial_data_structure, sky_environment, depth + 1);
+                    // Si en el rebote anterior también se muestreó la luz del cielo, la radiancia
+                    // que se encuentra al escapar se pondera para no contarla dos veces
+
+                    auto direction = normalize (ray.direction);
+                    auto radiance  = sky_environment.sample (direction);
+
+                    if (path.scatter_pdf > 0.f)
+                    {
+                        radiance *= power_heuristic (path.scatter_pdf, sky_environment.pdf (direction));
+                    }
+
+                    wavefront.radiance[path.lane] += path.throughput * radiance;
+
+                    continue;
                 }
 
-                return attenuation;
+                auto material = intersection.intersectable->material;
+
+                intersection.footprint = path.cone_width + path.cone_spread * intersection.t * length (ray.direction);
+
+                // Si la celda ya tiene bastantes muestras el camino termina con su valor (salvo
+                // algunos, que siguen para refinarla). Si no, se apunta para actualizarla.
+
+                if (radiance_cache && depth >= radiance_cache_depth && Materials::is_diffuse (*material))
+                {
+                    if (auto entry = radiance_cache->find (intersection.point, intersection.normal, material))
+                    {
+                        if (Radiance_Cache::is_trained (*entry)
+                        && (Radiance_Cache::is_saturated (*entry) || sampler.get_1d () >= Radiance_Cache::refresh_probability))
+                        {
+                            wavefront.radiance[path.lane] += path.throughput * Radiance_Cache::get_radiance (*entry);
+
+                            continue;
+                        }
+
+                        auto & record = wavefront.cache_records[path.lane];
+
+                        if (not record.entry)
+                        {
+                            record = Cache_Record{ entry, path.throughput, wavefront.radiance[path.lane] };
+                        }
+                    }
+                }
+
+                bool learn = path_guide && Materials::is_diffuse (*material);
+
+                const Path_Guide::Cell * guide_cell = learn ? path_guide->find_ready (intersection.point, intersection.normal) : nullptr;
+
+                if (sample_light)
+                {
+                    Ray   shadow_ray;
+                    Color radiance;
+
+                    if (sample_sky_light< SAMPLER, SCENE > (ray, intersection, sky_environment, guide_cell, sampler, shadow_ray, radiance))
+                    {
+                        wavefront.shadow_rays    .push_back (shadow_ray);
+                        wavefront.shadow_radiance.push_back (path.throughput * radiance);
+                        wavefront.shadow_lanes   .push_back (path.lane);
+                    }
+                }
+
+                Ray   scattered_ray;
+                Color attenuation;
+                float sampling_pdf = 0.f;
+
+                bool scattered = guide_cell
+                               ? scatter_guided< SAMPLER, SCENE > (ray, intersection, *guide_cell, sampler, scattered_ray, attenuation, sampling_pdf)
+                               : Materials::scatter (*material, ray, scattered_ray, intersection, attenuation, sampler);
+
+                if (scattered)
+                {
+                    if (depth < recursion_limit)
+                    {
+                        if ((sample_light || learn) && not guide_cell)
+                        {
+                            Materials::evaluate (*material, ray, intersection, scattered_ray.direction, sampling_pdf);
+                        }
+
+                        Color throughput = path.throughput * attenuation;
+
+                        // Tras un rebote difuso los rayos de un mismo píxel se separan mucho
+
+                        float cone_spread = Materials::is_diffuse (*material) ? std::max (path.cone_spread, diffuse_cone_spread) : path.cone_spread;
+
+                        wavefront.next_paths.push_back (Path{ throughput, sample_light ? sampling_pdf : 0.f, path.lane, intersection.footprint, cone_spread });
+                        wavefront.next_rays .push_back (scattered_ray);
+
+                        if (learn && sampling_pdf > 0.f)
+                        {
+                            auto direction = normalize (scattered_ray.direction);
+                            auto cosine    = dot (direction, intersection.normal);
+                            auto cell      = cosine > 0.f ? path_guide->find (intersection.point, intersection.normal) : nullptr;
+
+                            if (cell)
+                            {
+                                wavefront.guide_records.push_back (Guide_Record{ cell, intersection.normal, direction, sampling_pdf / cosine, throughput, Color(0, 0, 0), path.lane });
+                            }
+                        }
+                    }
+                    else
+                    {
+                        wavefront.radiance[path.lane] += path.throughput * attenuation;
+
+                        // Este término depende del rebote en que se corta el camino, no de la
+                        // celda, así que un camino que acaba aquí no enseña nada a la caché
+
+                        if (radiance_cache) wavefront.cache_records[path.lane].entry = nullptr;
+                    }
+                }
+            }
+
+            if (measured)
+            {
+                wavefront.sorter.record_shading (sorting, count, shading_timer.get_elapsed< Seconds > ());
+            }
+
+            // Rayos de sombra del rebote: solo importa si algo los tapa
+
+            if (not wavefront.shadow_rays.empty ())
+            {
+                benchmark.emitted_ray_count += wavefront.shadow_rays.size ();
+
+                wavefront.shadow_intersections.resize (wavefront.shadow_rays.size ());
+
+                spatial_data_structure.traverse (wavefront.shadow_rays, wavefront.shadow_intersections, Spatial_Data_Structure::ANY_HIT, 0.0001f, 10000.f);
+
+                for (size_t index = 0; index < wavefront.shadow_rays.size (); ++index)
+                {
+                    if (not wavefront.shadow_intersections[index].intersectable)
+                    {
+                        wavefront.radiance[wavefront.shadow_lanes[index]] += wavefront.shadow_radiance[index];
+                    }
+                }
+            }
+
+            // Lo que llegue a partir de aquí es lo que ha entrado por la dirección de cada rebote
+            // difuso de este nivel
+
+            for (size_t index = first_guide_record; index < wavefront.guide_records.size (); ++index)
+            {
+                wavefront.guide_records[index].radiance = wavefront.radiance[wavefront.guide_records[index].lane];
+            }
+
+            std::swap (wavefront.paths, wavefront.next_paths);
+            std::swap (wavefront.rays,  wavefront.next_rays );
+        }
+
+        for (auto & record : wavefront.guide_records)
+        {
+            if (record.throughput.r > 0.f && record.throughput.g > 0.f && record.throughput.b > 0.f)
+            {
+                Color incoming = (wavefront.radiance[record.lane] - record.radiance) / record.throughput;
+
+                Path_Guide::add_sample (*record.cell, record.normal, record.direction, luminance (incoming) / record.pdf);
+            }
+        }
+
+        if (radiance_cache)
+        {
+            for (size_t lane = 0; lane < wavefront.cache_records.size (); ++lane)
+            {
+                auto & record = wavefront.cache_records[lane];
+
+                if (record.entry && record.throughput.r > 0.f && record.throughput.g > 0.f && record.throughput.b > 0.f)
+                {
+                    Radiance_Cache::add_sample (*record.entry, (wavefront.radiance[lane] - record.radiance) / record.throughput);
+                }
             }
+        }
+    }
+
+    // Estimación directa de la luz del cielo (next event estimation): se elige una dirección según
+    // la distribución del cielo y se prepara el rayo de sombra junto con la aportación ponderada
+    // por MIS que habrá que sumar si no está tapado.
+
+    template< class SAMPLER, class SCENE >
+    bool Path_Tracer::sample_sky_light
+    (
+        const Ray                 & ray,
+        const Intersection        & intersection,
+        const typename SCENE::Sky & sky_environment,
+        const Path_Guide::Cell    * guide_cell,
+        SAMPLER                   & sampler,
+        Ray                       & shadow_ray,
+        Color                     & radiance
+    )
+    {
+        Vector3 direction;
+        float   light_pdf;
+
+        radiance = sky_environment.sample_direction (sampler.get_2d (), direction, light_pdf);
+
+        if (light_pdf <= 0.f) return false;
+
+        float   scatter_pdf;
+        Color   bsdf = SCENE::Materials::evaluate (*intersection.intersectable->material, ray, intersection, direction, scatter_pdf);
+
+        if (scatter_pdf <= 0.f) return false;
+
+        // Si el rebote se guía, la densidad con la que se habría elegido la dirección es la mezcla
+
+        if (guide_cell)
+        {
+            scatter_pdf = Path_Guide::guiding_probability * Path_Guide::pdf (*guide_cell, intersection.normal, normalize (direction))
+                        + (1.f - Path_Guide::guiding_probability) * scatter_pdf;
+        }
+
+        shadow_ray = Ray{ intersection.point, direction };
+        radiance   = bsdf * radiance * (power_heuristic (light_pdf, scatter_pdf) / light_pdf);
+
+        return true;
+    }
+
+    // Elige la dirección con la distribución aprendida o con la del material y la pondera con la
+    // densidad de la mezcla de las dos (MIS de una muestra con la heurística del balance), de modo
+    // que el valor esperado no depende de lo bien o mal que se haya aprendido.
+
+    template< class SAMPLER, class SCENE >
+    bool Path_Tracer::scatter_guided
+    (
+        const Ray              & ray,
+        const Intersection     & intersection,
+        const Path_Guide::Cell & guide_cell,
+        SAMPLER                & sampler,
+        Ray                    & scattered_ray,
+        Color                  & attenuation,
+        float                  & pdf
+    )
+    {
+        // La elección de estrategia sale del mismo par de valores que la dirección, para que el
+        // rebote siga usando las mismas dimensiones del sampler que sin guiado
+
+        constexpr float probability = Path_Guide::guiding_probability;
 
-            return Color(0, 0, 0);
+        auto    material = intersection.intersectable->material;
+        Vector2 random   = sampler.get_2d ();
+        Vector3 direction;
+
+        if (random.x < probability)
+        {
+            float guide_pdf;
+
+            direction = Path_Guide::sample (guide_cell, intersection.normal, Vector2(random.x / probability, random.y), guide_pdf);
         }
         else
-            return sky_environment.sample (udit::raytracer::normalize (ray.direction));
+        {
+            Replayed_Sampler replayed_sampler(sampler, Vector2((random.x - probability) / (1.f - probability), random.y));
+
+            if (not SCENE::Materials::scatter (*material, ray, scattered_ray, intersection, attenuation, replayed_sampler)) return false;
+
+            direction = normalize (scattered_ray.direction);
+        }
+
+        float bsdf_pdf;
+        Color bsdf = SCENE::Materials::evaluate (*material, ray, intersection, direction, bsdf_pdf);
+
+        // Las direcciones que el guiado propone por debajo de la superficie no aportan nada
+
+        if (bsdf_pdf <= 0.f) return false;
+
+        pdf = probability * Path_Guide::pdf (guide_cell, intersection.normal, direction) + (1.f - probability) * bsdf_pdf;
+
+        scattered_ray = Ray{ intersection.point, direction };
+        attenuation   = bsdf / pdf;
+
+        return true;
+    }
+
+    // Píxeles que se trazan en la fase actual del entrelazado. En 2x2 la fase recorre primero una
+    // diagonal del bloque y después la otra, para que dos fotogramas seguidos cubran posiciones
+    // opuestas.
+
+    bool Path_Tracer::is_interleaved_pixel (unsigned x, unsigned y) const
+    {
+        static constexpr unsigned quarter_order[] = { 0, 3, 1, 2 };
+
+        switch (interleaving.pattern)
+        {
+            case CHECKERBOARD:   return (x + y + interleaving.phase) % 2 == 0;
+            case INTERLEAVE_2X2: return (x % 2) + (y % 2) * 2 == quarter_order[interleaving.phase % 4];
+            default:             return true;
+        }
+    }
+
+    // Completa la imagen de un fotograma entrelazado en interleaving.reconstruction. Cada píxel sin
+    // trazar toma la media del par de vecinos trazados opuestos (horizontal, vertical o diagonal)
+    // que más se parecen entre sí, para interpolar a lo largo de los bordes y no a través de
+    // ellos. Si hay fotograma anterior, su valor se recorta al rango de los vecinos trazados (para
+    // que no queden estelas de lo que se ha movido) y se mezcla con la interpolación.
+
+    void Path_Tracer::reconstruct_stage (Frame_Data & frame_data)
+    {
+        // Si se ha cancelado, a la imagen le faltan píxeles que no se pueden reconstruir bien y
+        // no se va a mostrar
+
+        interleaving.reconstructed = frame_data.interleaved && not cancelled;
+
+        if (cancelled) return;
+
+        if (not frame_data.interleaved)
+        {
+            // La imagen de un fotograma completo no se guarda y deja de servir como historia
+            interleaving.history_valid = false;
+            return;
+        }
+
+        auto & image   = interleaving.reconstruction;
+        bool   history = interleaving.history_valid
+                      && image.get_width  () == framebuffer.get_width  ()
+                      && image.get_height () == framebuffer.get_height ();
+
+        image.set_layout (Buffer_Layout::ROW_MAJOR);
+        image.resize_as  (framebuffer);
+
+        int width  = int(framebuffer.get_width  ());
+        int height = int(framebuffer.get_height ());
+
+        std::vector< int > rows(height);
+        std::iota (rows.begin (), rows.end (), 0);
+
+        std::for_each (std::execution::par, rows.begin (), rows.end (), [&](int y)
+        {
+            static constexpr int pairs[4][4] = { { -1, 0, 1, 0 }, { 0, -1, 0, 1 }, { -1, -1, 1, 1 }, { 1, -1, -1, 1 } };
+
+            auto traced = [&](int column, int row)
+            {
+                return column >= 0 && row >= 0 && column < width && row < height
+                    && framebuffer.get (unsigned(column), unsigned(row)).get_sample_count () > 0.f;
+            };
+
+            for (int x = 0; x < width; ++x)
+            {
+                if (traced (x, y))
+                {
+                    image.set (unsigned(x), unsigned(y), framebuffer.get (unsigned(x), unsigned(y)).get_average ());
+                    continue;
+                }
+
+                Color    minimum(std::numeric_limits< float >::max ());
+                Color    maximum(0.f);
+                Color    sum    (0.f);
+                unsigned count = 0;
+
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        if (traced (x + dx, y + dy))
+                        {
+                            Color neighbour = framebuffer.get (unsigned(x + dx), unsigned(y + dy)).get_average ();
+
+                            minimum  = glm::min (minimum, neighbour);
+                            maximum  = glm::max (maximum, neighbour);
+                            sum     += neighbour;
+                            count   += 1;
+                        }
+                    }
+                }
+
+                Color spatial    = count > 0 ? sum / float(count) : Color(0.f);
+                float difference = std::numeric_limits< float >::max ();
+
+                for (auto & pair : pairs)
+                {
+                    if (traced (x + pair[0], y + pair[1]) && traced (x + pair[2], y + pair[3]))
+                    {
+                        Color a = framebuffer.get (unsigned(x + pair[0]), unsigned(y + pair[1])).get_average ();
+                        Color b = framebuffer.get (unsigned(x + pair[2]), unsigned(y + pair[3])).get_average ();
+
+                        if (std::abs (luminance (a) - luminance (b)) < difference)
+                        {
+                            difference = std::abs (luminance (a) - luminance (b));
+                            spatial    = (a + b) * .5f;
+                        }
+                    }
+                }
+
+                Color result = spatial;
+
+                if (history)
+                {
+                    Color previous = image.get (unsigned(x), unsigned(y));
+
+                    result = count > 0 ? (spatial + glm::clamp (previous, minimum, maximum)) * .5f : previous;
+                }
+
+                image.set (unsigned(x), unsigned(y), result);
+            }
+        });
+
+        interleaving.history_valid = true;
+        interleaving.phase++;
     }
 
 }
@@ -56,12 +56,15 @@ namespace udit::raytracer
         //Calculamos cada rayo de forma paralela (uno por pixel)
         std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t index)
             {
-                //Se convierte el indice lineal a coordenadas 2D
-                int x = static_cast<int>(index % buffer_width);
-                int y = static_cast<int>(index / buffer_width);
+                //Se convierte la posicion en el buffer a coordenadas 2D (segun como este organizado)
+                unsigned pixel_x, pixel_y;
+
+                primary_rays.coordinates_of (static_cast<unsigned>(index), pixel_x, pixel_y);
+
+                int x = static_cast<int>(pixel_x);
 
                 //Y tambien aqui he tenido que invertir la vertical
-                y = buffer_height - 1 - y;
+                int y = static_cast<int>(buffer_height - 1 - pixel_y);
 
                 //Se calcula la posicion del pixel sobre el sensor
                 Vector3 pixel_position = sensor_bottom_left + horizontal_step * static_cast<float>(x) + vertical_step * static_cast<float>(y);
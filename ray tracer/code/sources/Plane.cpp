@@ -25,4 +25,30 @@ namespace udit::raytracer
         return -1.f;
     }
 
+    // En el lote el plano se recorta una sola vez: punto · normal es constante para todos los rayos
+
+    void Plane::intersect (std::span< const Ray > rays, float min_t, std::span< Intersection > intersections) const
+    {
+        const Vector3 normal = this->normal;
+        const float   offset = dot (point, normal);
+
+        for (size_t index = 0, count = rays.size (); index < count; ++index)
+        {
+            const Ray & ray = rays[index];
+
+            float denominator = dot (normal, ray.direction);
+
+            if (fabs (denominator) > epsilon)
+            {
+                float t = (offset - dot (ray.origin, normal)) / denominator;
+
+                if (t > min_t && t < intersections[index].t)
+                {
+                    intersections[index].t = t;
+                    intersections[index].intersectable = const_cast< Plane * >(this);
+                }
+            }
+        }
+    }
+
 }
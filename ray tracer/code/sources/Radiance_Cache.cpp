@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <execution>
+
+#include <raytracer/Radiance_Cache.hpp>
+
+namespace udit::raytracer
+{
+
+    Radiance_Cache::Radiance_Cache(float cell_size, unsigned capacity_bits)
+    :
+        grid(cell_size, capacity_bits)
+    {
+        clear ();
+    }
+
+    void Radiance_Cache::clear ()
+    {
+        std::for_each (std::execution::par_unseq, grid.begin (), grid.end (), [](Entry & entry)
+        {
+            entry.key  .store (0,   std::memory_order_relaxed);
+            entry.red  .store (0.f, std::memory_order_relaxed);
+            entry.green.store (0.f, std::memory_order_relaxed);
+            entry.blue .store (0.f, std::memory_order_relaxed);
+            entry.count.store (0,   std::memory_order_relaxed);
+        });
+    }
+
+    Radiance_Cache::Entry * Radiance_Cache::find (const Vector3 & point, const Vector3 & normal, const Material * material)
+    {
+        return grid.find (grid.key_of (point, normal, uint64_t(reinterpret_cast< uintptr_t >(material))));
+    }
+
+}
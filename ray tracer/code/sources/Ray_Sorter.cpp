@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <typeinfo>
+
+#include <raytracer/Intersectable.hpp>
+#include <raytracer/Intersection.hpp>
+#include <raytracer/Material.hpp>
+#include <raytracer/Ray_Sorter.hpp>
+
+namespace udit::raytracer
+{
+
+    bool Ray_Sorter::wants_material_sorting (size_t batch_size)
+    {
+        if (not pays_off (batch_size)) return false;
+
+        ++batch_count;
+
+        // Hasta tener medidas de las dos opciones se alternan
+
+        if (costs[0].rays == 0.0 || costs[1].rays == 0.0) return costs[1].rays == 0.0;
+
+        bool sorting_is_cheaper = costs[1].seconds / costs[1].rays < costs[0].seconds / costs[0].rays;
+
+        return batch_count % trial_period == 0 ? not sorting_is_cheaper : sorting_is_cheaper;
+    }
+
+    void Ray_Sorter::record_shading (bool sorted, size_t batch_size, float seconds)
+    {
+        auto & cost = costs[sorted ? 1 : 0];
+
+        cost.seconds = cost.seconds * cost_decay + double(seconds);
+        cost.rays    = cost.rays    * cost_decay + double(batch_size);
+    }
+
+    bool Ray_Sorter::sort_by_material (std::span< const Intersection > intersections, std::vector< uint32_t > & order)
+    {
+        if (not pays_off (intersections.size ())) return false;
+
+        entries.resize (intersections.size ());
+
+        for (uint32_t index = 0; index < uint32_t(intersections.size ()); ++index)
+        {
+            auto intersectable = intersections[index].intersectable;
+
+            if (intersectable)
+            {
+                auto material = intersectable->material;
+
+                entries[index] = Entry{ typeid (*material).hash_code () | 1, reinterpret_cast< uintptr_t >(material), index };
+            }
+            else
+            {
+                entries[index] = Entry{ 0, 0, index };
+            }
+        }
+
+        return sort_entries (order);
+    }
+
+    bool Ray_Sorter::sort_entries (std::vector< uint32_t > & order)
+    {
+        // Si todas las claves coinciden no hay nada que agrupar
+
+        auto differs = [first = entries.front ()](const Entry & entry)
+        {
+            return entry.primary_key != first.primary_key || entry.secondary_key != first.secondary_key;
+        };
+
+        if (std::none_of (entries.begin (), entries.end (), differs)) return false;
+
+        std::sort
+        (
+            entries.begin (),
+            entries.end   (),
+            [](const Entry & a, const Entry & b)
+            {
+                return a.primary_key != b.primary_key ? a.primary_key < b.primary_key : a.secondary_key < b.secondary_key;
+            }
+        );
+
+        order.resize (entries.size ());
+
+        for (size_t index = 0; index < entries.size (); ++index)
+        {
+            order[index] = entries[index].index;
+        }
+
+        return true;
+    }
+
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <raytracer/Render_Checkpoint.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #define MEMORY_MAPPING_AVAILABLE 1
+
+#endif
+
+namespace udit::raytracer
+{
+
+    namespace
+    {
+
+        constexpr char magic[8] = { 'U', 'R', 'T', 'A', 'C', 'C', 'U', 'M' };
+
+        size_t get_file_size (unsigned width, unsigned height)
+        {
+            return Render_Checkpoint::data_offset + size_t(width) * height * sizeof(Accumulated_Color);
+        }
+
+        bool has_valid_header (const Render_Checkpoint::Header & header)
+        {
+            return std::memcmp (header.magic, magic, sizeof(magic)) == 0
+                && header.version      == Render_Checkpoint::version
+                && header.element_size == sizeof(Accumulated_Color);
+        }
+
+    }
+
+    bool Render_Checkpoint::matches_camera (const Matrix4 & matrix, float focal_length) const
+    {
+        auto & header = get_header ();
+
+        return std::memcmp (header.camera_matrix, &matrix[0][0], sizeof(header.camera_matrix)) == 0
+            && header.focal_length == focal_length;
+    }
+
+    void Render_Checkpoint::set_camera (const Matrix4 & matrix, float focal_length)
+    {
+        auto & header = get_header ();
+
+        std::memcpy (header.camera_matrix, &matrix[0][0], sizeof(header.camera_matrix));
+
+        header.focal_length = focal_length;
+    }
+
+    #if defined(MEMORY_MAPPING_AVAILABLE)
+
+    bool Render_Checkpoint::open
+    (
+        const std::string & path,
+        unsigned            width,
+        unsigned            height,
+        Buffer_Layout       layout,
+        uint64_t            scene_hash,
+        uint32_t            sample_offset
+    )
+    {
+        close ();
+
+        file = ::open (path.c_str (), O_RDWR | O_CREAT, 0644);
+
+        if (file < 0) return false;
+
+        // Se comprueba la cabecera antes de proyectar. Solo se escribe una cabecera nueva en un
+        // fichero vacío: uno que ya tiene datos puede ser la acumulación de otro render (de otra
+        // escena o con otro viewport) y no se sobrescribe.
+
+        size_t expected_size = get_file_size (width, height);
+        Header header;
+        struct stat status;
+
+        if (fstat (file, &status) != 0)
+        {
+            close ();
+            return false;
+        }
+
+        bool is_empty   = status.st_size == 0;
+        bool compatible = size_t(status.st_size) == expected_size
+                       && ::pread (file, &header, sizeof(header), 0) == ssize_t(sizeof(header))
+                       && has_valid_header (header)
+                       && header.width         == width
+                       && header.height        == height
+                       && header.layout        == uint32_t(layout)
+                       && header.scene_hash    == scene_hash
+                       && header.sample_offset == sample_offset;
+
+        if (not compatible)
+        {
+            if (not is_empty || ::ftruncate (file, off_t(expected_size)) != 0)
+            {
+                close ();
+                return false;
+            }
+        }
+
+        mapping = ::mmap (nullptr, expected_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            mapping = nullptr;
+            close ();
+            return false;
+        }
+
+        mapping_size = expected_size;
+
+        if (not compatible)
+        {
+            // ftruncate() rellena con ceros, que es una acumulación vacía
+
+            auto & new_header = get_header ();
+
+            std::memcpy (new_header.magic, magic, sizeof(magic));
+
+            new_header.version       = version;
+            new_header.element_size  = sizeof(Accumulated_Color);
+            new_header.width         = width;
+            new_header.height        = height;
+            new_header.layout        = uint32_t(layout);
+            new_header.sample_offset = sample_offset;
+            new_header.sample_skip   = 0;
+            new_header.scene_hash    = scene_hash;
+            new_header.total_samples = 0;
+        }
+
+        return compatible;
+    }
+
+    bool Render_Checkpoint::merge (const std::string & other_path)
+    {
+        if (not is_open ()) return false;
+
+        int other_file = ::open (other_path.c_str (), O_RDONLY);
+
+        if (other_file < 0) return false;
+
+        auto & header = get_header ();
+        Header other_header;
+        struct stat status;
+
+        bool compatible = fstat (other_file, &status) == 0
+                       && size_t(status.st_size) == mapping_size
+                       && ::pread (other_file, &other_header, sizeof(other_header), 0) == ssize_t(sizeof(other_header))
+                       && has_valid_header (other_header)
+                       && other_header.width         == header.width
+                       && other_header.height        == header.height
+                       && other_header.layout        == header.layout
+                       && other_header.scene_hash    == header.scene_hash
+                       && other_header.sample_offset != header.sample_offset
+                       && other_header.focal_length  == header.focal_length
+                       && std::memcmp (other_header.camera_matrix, header.camera_matrix, sizeof(header.camera_matrix)) == 0;
+
+        // Cada uno ha usado como mucho las muestras de su secuencia anteriores a su comienzo más
+        // las que tiene acumuladas
+
+        uint64_t first_sample       = uint64_t(header      .sample_offset) + header      .sample_skip;
+        uint64_t other_first_sample = uint64_t(other_header.sample_offset) + other_header.sample_skip;
+        uint64_t merged_skip        = std::max (first_sample, other_first_sample) - header.sample_offset;
+
+        compatible = compatible && merged_skip <= UINT32_MAX;
+
+        void * other_mapping = compatible ? ::mmap (nullptr, mapping_size, PROT_READ, MAP_SHARED, other_file, 0) : MAP_FAILED;
+
+        ::close (other_file);
+
+        if (other_mapping == MAP_FAILED) return false;
+
+        auto   pixels       = get_pixels ();
+        auto   other_pixels = reinterpret_cast< const Accumulated_Color * >(static_cast< const std::byte * >(other_mapping) + data_offset);
+        size_t count        = size_t(header.width) * header.height;
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            pixels[index] += other_pixels[index];
+        }
+
+        header.total_samples += other_header.total_samples;
+        header.sample_skip    = uint32_t(merged_skip);
+
+        ::munmap (other_mapping, mapping_size);
+
+        return true;
+    }
+
+    void Render_Checkpoint::flush ()
+    {
+        if (mapping) ::msync (mapping, mapping_size, MS_ASYNC);
+    }
+
+    void Render_Checkpoint::close ()
+    {
+        if (mapping)
+        {
+            ::msync  (mapping, mapping_size, MS_ASYNC);
+            ::munmap (mapping, mapping_size);
+        }
+
+        if (file >= 0) ::close (file);
+
+        file         = -1;
+        mapping      = nullptr;
+        mapping_size = 0;
+    }
+
+    #else
+
+    bool Render_Checkpoint::open (const std::string & , unsigned , unsigned , Buffer_Layout , uint64_t , uint32_t )
+    {
+        return false;
+    }
+
+    bool Render_Checkpoint::merge (const std::string & )
+    {
+        return false;
+    }
+
+    void Render_Checkpoint::flush ()
+    {
+    }
+
+    void Render_Checkpoint::close ()
+    {
+    }
+
+    #endif
+
+}
@@ -0,0 +1,416 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+
+#include <raytracer/Camera.hpp>
+#include <raytracer/Render_Coordinator.hpp>
+
+namespace udit::raytracer
+{
+
+    Render_Coordinator::~Render_Coordinator()
+    {
+        {
+            std::lock_guard lock(mutex);
+
+            running = false;
+        }
+
+        work_available.notify_all ();
+
+        // Cada hilo termina cuando le llegan los resultados que aún esperaba. Después se despide
+        // a los trabajadores.
+
+        for (auto & worker : workers)
+        {
+            if (worker->thread.joinable ()) worker->thread.join ();
+
+            Render_Message stop{ Render_Message::STOP, 0 };
+
+            worker->connection.send_all (&stop, sizeof(stop));
+            worker->connection.close ();
+        }
+    }
+
+    unsigned Render_Coordinator::accept_workers (unsigned count)
+    {
+        for (unsigned index = 0; index < count && listener.is_open (); ++index)
+        {
+            Socket connection = listener.accept ();
+
+            if (not connection.is_open ()) break;
+
+            std::lock_guard lock(mutex);
+
+            auto & worker = *workers.emplace_back (std::make_unique< Worker > ());
+
+            worker.connection = std::move (connection);
+            worker.thread     = std::thread([this, &worker] () { serve (worker); });
+        }
+
+        return get_worker_count ();
+    }
+
+    unsigned Render_Coordinator::get_worker_count ()
+    {
+        std::lock_guard lock(mutex);
+
+        return unsigned(std::count_if (workers.begin (), workers.end (), [](auto & worker) { return worker->alive; }));
+    }
+
+    bool Render_Coordinator::render
+    (
+        Camera                      & camera,
+        unsigned                      viewport_width,
+        unsigned                      viewport_height,
+        uint32_t                      first_sample,
+        unsigned                      samples_per_pixel,
+        Buffer< Accumulated_Color > & given_accumulation
+    )
+    {
+        std::unique_lock lock(mutex);
+
+        std::vector< Worker * > alive_workers;
+
+        for (auto & worker : workers)
+        {
+            if (worker->alive) alive_workers.push_back (worker.get ());
+        }
+
+        if (alive_workers.empty ()) return false;
+
+        // Los trabajadores rechazan lo que no cabe en los límites del protocolo
+
+        if (not Render_Limits::is_valid_viewport (viewport_width, viewport_height) || samples_per_pixel == 0) return false;
+
+        given_accumulation.resize (viewport_width, viewport_height);
+
+        Render_Camera_State camera_state;
+
+        auto & position = camera.transform.get_position ();
+        auto & rotation = camera.transform.get_rotation ();
+        auto & scales   = camera.transform.get_scales   ();
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            camera_state.position[axis] = position[axis];
+            camera_state.rotation[axis] = rotation[axis];
+            camera_state.scales  [axis] = scales  [axis];
+        }
+
+        camera_state.focal_length = camera.get_focal_length ();
+
+        // Los trabajos se ordenan por baldosa y, dentro de cada una, por rango de muestras. Cada
+        // trabajador recibe un bloque seguido de baldosas, y al robar se llevan las del final.
+
+        ++frame;
+
+        jobs.clear ();
+
+        for (unsigned tile_y = 0; tile_y < viewport_height; tile_y += tile_size)
+        {
+            for (unsigned tile_x = 0; tile_x < viewport_width; tile_x += tile_size)
+            {
+                for (unsigned sample = 0; sample < samples_per_pixel; sample += samples_per_job)
+                {
+                    Render_Job description
+                    {
+                        frame,
+                        uint32_t(jobs.size ()),
+                        viewport_width,
+                        viewport_height,
+                        tile_x,
+                        tile_y,
+                        std::min (tile_size, viewport_width  - tile_x),
+                        std::min (tile_size, viewport_height - tile_y),
+                        first_sample + sample,
+                        std::min (samples_per_job, samples_per_pixel - sample),
+                        camera_state
+                    };
+
+                    jobs.push_back (Job{ description, false, 0, Timer() });
+                }
+            }
+        }
+
+        for (size_t index = 0; index < alive_workers.size (); ++index)
+        {
+            auto & queue = alive_workers[index]->queue;
+
+            size_t first = jobs.size () *  index      / alive_workers.size ();
+            size_t last  = jobs.size () * (index + 1) / alive_workers.size ();
+
+            queue.clear ();
+
+            for (size_t job = first; job < last; ++job)
+            {
+                queue.push_back (uint32_t(job));
+            }
+        }
+
+        remaining_jobs = jobs.size ();
+        accumulation   = &given_accumulation;
+
+        work_available.notify_all ();
+
+        frame_completed.wait (lock, [this] ()
+        {
+            return remaining_jobs == 0 || std::none_of (workers.begin (), workers.end (), [](auto & worker) { return worker->alive; });
+        });
+
+        accumulation = nullptr;
+
+        return remaining_jobs == 0;
+    }
+
+    // Hilo que atiende a un trabajador: le mantiene hasta jobs_in_flight trabajos enviados y
+    // recoge sus resultados.
+
+    void Render_Coordinator::serve (Worker & worker)
+    {
+        std::vector< Accumulated_Color > pixels;
+
+        std::unique_lock lock(mutex);
+
+        while (worker.alive && (running || not worker.in_flight.empty ()))
+        {
+            uint32_t job_index;
+
+            while (worker.in_flight.size () < jobs_in_flight && next_job (worker, job_index))
+            {
+                auto & job = jobs[job_index];
+
+                if (job.copies++ == 0) job.dispatch_timer.reset ();
+
+                worker.in_flight.push_back (Dispatched_Job{ frame, job_index, job.description.tile_width * job.description.tile_height });
+
+                Render_Message message    { Render_Message::JOB, sizeof(Render_Job) };
+                Render_Job     description = job.description;
+
+                lock.unlock ();
+
+                bool sent = worker.connection.send_all (&message,     sizeof(message    ))
+                         && worker.connection.send_all (&description, sizeof(description));
+
+                lock.lock ();
+
+                if (not sent) { abandon (worker); return; }
+            }
+
+            if (worker.in_flight.empty ())
+            {
+                if (running) work_available.wait (lock);
+
+                continue;
+            }
+
+            lock.unlock ();
+
+            Render_Message message;
+            Render_Result  result;
+
+            bool received = worker.connection.receive_all (&message, sizeof(message))
+                         && message.type == Render_Message::RESULT
+                         && worker.connection.receive_all (&result,  sizeof(result ));
+
+            lock.lock ();
+
+            if (not received) { abandon (worker); return; }
+
+            auto find_dispatched = [&worker, &result] ()
+            {
+                return std::find_if (worker.in_flight.begin (), worker.in_flight.end (), [&result](auto & entry)
+                {
+                    return entry.frame == result.frame && entry.job == result.job;
+                });
+            };
+
+            // El tamaño viene de la red: antes de reservar memoria se comprueba que el resultado es
+            // de un trabajo enviado a este trabajador y trae los píxeles de su baldosa
+
+            auto dispatched = find_dispatched ();
+
+            if (dispatched == worker.in_flight.end () || dispatched->pixel_count != result.pixel_count)
+            {
+                abandon (worker);
+                return;
+            }
+
+            lock.unlock ();
+
+            pixels.resize (result.pixel_count);
+
+            received = worker.connection.receive_all (pixels.data (), pixels.size () * sizeof(Accumulated_Color));
+
+            lock.lock ();
+
+            if (not received) { abandon (worker); return; }
+
+            dispatched = find_dispatched ();
+
+            if (dispatched != worker.in_flight.end ()) worker.in_flight.erase (dispatched);
+
+            if (result.frame == frame && result.job < jobs.size ())
+            {
+                auto & job = jobs[result.job];
+
+                job.copies--;
+
+                if (not job.completed && result.pixel_count == job.description.tile_width * job.description.tile_height)
+                {
+                    merge (job.description, pixels.data ());
+
+                    job.completed = true;
+
+                    if (--remaining_jobs == 0) frame_completed.notify_all ();
+                }
+            }
+        }
+    }
+
+    // Siguiente trabajo para el trabajador: primero de su cola, si no robando la mitad de la cola
+    // más larga y, en último caso, duplicando el trabajo pendiente más antiguo de otro.
+
+    bool Render_Coordinator::next_job (Worker & worker, uint32_t & job_index)
+    {
+        if (not running || remaining_jobs == 0) return false;
+
+        auto take_from_queue = [&] ()
+        {
+            while (not worker.queue.empty ())
+            {
+                job_index = worker.queue.front ();
+
+                worker.queue.pop_front ();
+
+                if (not jobs[job_index].completed && jobs[job_index].copies == 0) return true;
+            }
+
+            return false;
+        };
+
+        if (take_from_queue ()) return true;
+
+        Worker * victim = nullptr;
+
+        for (auto & other : workers)
+        {
+            if (other.get () != &worker && other->alive && (not victim || other->queue.size () > victim->queue.size ()))
+            {
+                victim = other.get ();
+            }
+        }
+
+        if (victim && not victim->queue.empty ())
+        {
+            size_t stolen = (victim->queue.size () + 1) / 2;
+
+            worker.queue.insert (worker.queue.end (), victim->queue.end () - stolen, victim->queue.end ());
+            victim->queue.erase (victim->queue.end () - stolen, victim->queue.end ());
+
+            if (take_from_queue ()) return true;
+        }
+
+        float    oldest_time = -1.f;
+        uint32_t oldest_job  = 0;
+
+        for (auto & other : workers)
+        {
+            if (other.get () == &worker || not other->alive) continue;
+
+            for (auto & dispatched : other->in_flight)
+            {
+                if (dispatched.frame != frame) continue;
+
+                auto & job = jobs[dispatched.job];
+
+                if (not job.completed && job.copies == 1)
+                {
+                    float time = job.dispatch_timer.get_elapsed< Seconds > ();
+
+                    if (time > oldest_time)
+                    {
+                        oldest_time = time;
+                        oldest_job  = dispatched.job;
+                    }
+                }
+            }
+        }
+
+        if (oldest_time >= 0.f)
+        {
+            job_index = oldest_job;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void Render_Coordinator::merge (const Render_Job & job, const Accumulated_Color * pixels)
+    {
+        for (unsigned y = 0; y < job.tile_height; ++y)
+        {
+            for (unsigned x = 0; x < job.tile_width; ++x)
+            {
+                unsigned offset = accumulation->offset_of (job.tile_x + x, job.tile_y + y);
+
+                (*accumulation)[offset] += pixels[y * job.tile_width + x];
+            }
+        }
+    }
+
+    // El trabajador se ha desconectado: lo que tenía pendiente se reparte entre los demás.
+
+    void Render_Coordinator::abandon (Worker & worker)
+    {
+        worker.alive = false;
+
+        worker.connection.close ();
+
+        for (auto & dispatched : worker.in_flight)
+        {
+            if (dispatched.frame == frame && --jobs[dispatched.job].copies == 0 && not jobs[dispatched.job].completed)
+            {
+                worker.queue.push_back (dispatched.job);
+            }
+        }
+
+        worker.in_flight.clear ();
+
+        while (not worker.queue.empty ())
+        {
+            Worker * heir = find_shortest_queue ();
+
+            if (not heir) break;
+
+            heir->queue.push_back (worker.queue.front ());
+
+            worker.queue.pop_front ();
+        }
+
+        work_available .notify_all ();
+        frame_completed.notify_all ();
+    }
+
+    Render_Coordinator::Worker * Render_Coordinator::find_shortest_queue ()
+    {
+        Worker * shortest = nullptr;
+
+        for (auto & worker : workers)
+        {
+            if (worker->alive && (not shortest || worker->queue.size () < shortest->queue.size ()))
+            {
+                shortest = worker.get ();
+            }
+        }
+
+        return shortest;
+    }
+
+}
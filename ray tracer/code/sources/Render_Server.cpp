@@ -0,0 +1,276 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <cstring>
+#include <exception>
+
+#include <raytracer/Camera.hpp>
+#include <raytracer/Image_File.hpp>
+#include <raytracer/Render_Server.hpp>
+#include <raytracer/Scene.hpp>
+
+namespace udit::raytracer
+{
+
+    Render_Server::~Render_Server()
+    {
+        stop ();
+    }
+
+    unsigned Render_Server::run ()
+    {
+        unsigned completed_jobs = 0;
+
+        acceptor = std::thread([this] () { accept_clients (); });
+
+        std::unique_lock lock(mutex);
+
+        while (true)
+        {
+            job_available.wait (lock, [this] () { return not running || not queue.empty (); });
+
+            if (not running) break;
+
+            Job job = queue.top ();
+
+            queue.pop ();
+
+            states[job.id] = Render_Job_Status::RUNNING;
+
+            // Mientras se traza, los clientes pueden seguir encolando y preguntando
+
+            lock.unlock ();
+
+            bool completed;
+
+            try
+            {
+                completed = execute (job.description);
+            }
+            catch (const std::exception & )         // Por ejemplo, bad_alloc: falla el trabajo, no el servidor
+            {
+                completed = false;
+            }
+
+            lock.lock ();
+
+            finish_job (job.id, completed);
+
+            if (completed) ++completed_jobs;
+        }
+
+        lock.unlock ();
+
+        // Se deja de aceptar clientes y se despierta a los que esperan un mensaje. Cuando el hilo
+        // que acepta ha terminado ya no se añaden más.
+
+        listener.shutdown ();
+
+        if (acceptor.joinable ()) acceptor.join ();
+
+        lock.lock ();
+
+        for (auto & client : clients)
+        {
+            if (not client->finished) client->connection.shutdown ();
+        }
+
+        lock.unlock ();
+
+        for (auto & client : clients)
+        {
+            if (client->thread.joinable ()) client->thread.join ();
+        }
+
+        clients .clear ();
+        listener.close ();
+
+        return completed_jobs;
+    }
+
+    void Render_Server::stop ()
+    {
+        {
+            std::lock_guard lock(mutex);
+
+            running = false;
+        }
+
+        job_available.notify_all ();
+    }
+
+    void Render_Server::accept_clients ()
+    {
+        while (true)
+        {
+            Socket connection = listener.accept ();
+
+            if (not connection.is_open ()) break;
+
+            std::lock_guard lock(mutex);
+
+            if (not running) break;
+
+            remove_finished_clients ();
+
+            auto & client = *clients.emplace_back (std::make_unique< Client > ());
+
+            client.connection = std::move (connection);
+            client.thread     = std::thread([this, &client] () { serve (client); });
+        }
+    }
+
+    // Los hilos de los clientes que ya han terminado se recogen al aceptar otro, para que un
+    // servidor que atiende muchas conexiones no acumule hilos ni sockets. Se llama con el mutex
+    // bloqueado: el hilo ya no lo necesita, así que join() solo espera a que acabe de salir.
+
+    void Render_Server::remove_finished_clients ()
+    {
+        std::erase_if
+        (
+            clients,
+            [] (const std::unique_ptr< Client > & client)
+            {
+                if (not client->finished) return false;
+
+                client->thread.join ();
+
+                return true;
+            }
+        );
+    }
+
+    // Cada petición recibe como respuesta el estado del trabajo. Al terminar, la conexión se
+    // cierra con el mutex bloqueado, porque run() puede estar usándola para despertar a este hilo.
+
+    void Render_Server::serve (Client & client)
+    {
+        Render_Message message;
+
+        while (client.connection.receive_all (&message, sizeof(message)))
+        {
+            Render_Job_Status status;
+
+            if (message.type == Render_Message::SUBMIT && message.size == sizeof(Render_Server_Job))
+            {
+                Render_Server_Job description;
+
+                if (not client.connection.receive_all (&description, sizeof(description))) break;
+
+                status = submit (description);
+            }
+            else
+            if (message.type == Render_Message::QUERY && message.size == sizeof(uint32_t))
+            {
+                uint32_t id;
+
+                if (not client.connection.receive_all (&id, sizeof(id))) break;
+
+                status = get_status (id);
+            }
+            else
+            {
+                if (message.type == Render_Message::STOP) stop ();
+
+                break;          // STOP o un mensaje que no se entiende
+            }
+
+            Render_Message reply{ Render_Message::STATUS, uint32_t(sizeof(status)) };
+
+            if (not client.connection.send_all (&reply,  sizeof(reply ))
+            ||  not client.connection.send_all (&status, sizeof(status))) break;
+        }
+
+        std::lock_guard lock(mutex);
+
+        client.connection.close ();
+        client.finished = true;
+    }
+
+    Render_Job_Status Render_Server::submit (const Render_Server_Job & description)
+    {
+        std::lock_guard lock(mutex);
+
+        Job job{ next_id++, description };
+
+        job.description.output_path[sizeof(job.description.output_path) - 1] = '\0';
+
+        // Los tamaños vienen de la red: un trabajo que no cabe en los límites falla sin encolarse
+
+        if (not Render_Limits::is_valid_viewport     (description.viewport_width, description.viewport_height)
+        ||  not Render_Limits::is_valid_sample_count (description.samples_per_pixel))
+        {
+            finish_job (job.id, false);
+
+            return { job.id, Render_Job_Status::FAILED, uint32_t(queue.size ()) };
+        }
+
+        states[job.id] = Render_Job_Status::QUEUED;
+
+        queue.push (job);
+
+        job_available.notify_one ();
+
+        return { job.id, Render_Job_Status::QUEUED, uint32_t(queue.size ()) };
+    }
+
+    Render_Job_Status Render_Server::get_status (uint32_t id)
+    {
+        std::lock_guard lock(mutex);
+
+        auto found = states.find (id);
+
+        return { id, found != states.end () ? found->second : Render_Job_Status::UNKNOWN, uint32_t(queue.size ()) };
+    }
+
+    // Se llama con el mutex bloqueado
+
+    void Render_Server::finish_job (uint32_t id, bool completed)
+    {
+        states[id] = completed ? Render_Job_Status::COMPLETED : Render_Job_Status::FAILED;
+
+        finished_jobs.push_back (id);
+
+        if (finished_jobs.size () > max_finished_states)
+        {
+            states.erase (finished_jobs.front ());
+
+            finished_jobs.pop_front ();
+        }
+    }
+
+    // Como en Render_Worker, la cámara del trabajo se aplica a la de la escena. La estructura
+    // espacial solo se reconstruye si la escena ha cambiado desde el trabajo anterior.
+
+    bool Render_Server::execute (const Render_Server_Job & job)
+    {
+        auto camera = path_tracer.get_camera (space.get_scene ());
+
+        if (camera == nullptr) return false;
+
+        camera->transform.set_position (Vector3(job.camera.position[0], job.camera.position[1], job.camera.position[2]));
+        camera->transform.set_rotation (Vector3(job.camera.rotation[0], job.camera.rotation[1], job.camera.rotation[2]));
+        camera->transform.set_scales   (Vector3(job.camera.scales  [0], job.camera.scales  [1], job.camera.scales  [2]));
+        camera->set_focal_length       (job.camera.focal_length);
+
+        // Cada trabajo se traza aparte, sin mezclarse con lo acumulado por los anteriores
+
+        Path_Tracer::Tile tile{ 0, 0, job.viewport_width, job.viewport_height };
+
+        path_tracer.trace_tile (space, job.viewport_width, job.viewport_height, tile, 0, job.samples_per_pixel, accumulation);
+
+        image.resize_as (accumulation);
+
+        for (unsigned offset = 0, size = accumulation.size (); offset < size; ++offset)
+        {
+            image.set (offset, accumulation.get (offset).get_average ());
+        }
+
+        return Image_File::write_pfm (std::string(job.output_path, strnlen (job.output_path, sizeof(job.output_path))), image);
+    }
+
+}
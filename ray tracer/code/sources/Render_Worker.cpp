@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <cstdint>
+
+#include <raytracer/Camera.hpp>
+#include <raytracer/Render_Protocol.hpp>
+#include <raytracer/Render_Worker.hpp>
+#include <raytracer/Scene.hpp>
+
+namespace udit::raytracer
+{
+
+    unsigned Render_Worker::run ()
+    {
+        unsigned completed_jobs = 0;
+
+        Render_Message message;
+
+        while (connection.receive_all (&message, sizeof(message)))
+        {
+            if (message.type == Render_Message::JOB && message.size == sizeof(Render_Job))
+            {
+                Render_Job job;
+
+                if (not connection.receive_all (&job, sizeof(job)) || not execute (job)) break;
+
+                ++completed_jobs;
+            }
+            else
+            {
+                break;          // STOP o un mensaje que no se entiende
+            }
+        }
+
+        connection.close ();
+
+        return completed_jobs;
+    }
+
+    // Los tamaños vienen de la red y trace_tile() no los comprueba: solo se acepta una baldosa que
+    // quede dentro de un viewport que no supere los límites. Con cualquier otra cosa el trabajador
+    // se desconecta, igual que con un mensaje que no entiende.
+
+    bool Render_Worker::is_valid (const Render_Job & job)
+    {
+        return Render_Limits::is_valid_viewport     (job.viewport_width, job.viewport_height)
+            && Render_Limits::is_valid_sample_count (job.number_of_samples)
+            && job.tile_width  > 0 && job.tile_x < job.viewport_width  && job.tile_width  <= job.viewport_width  - job.tile_x
+            && job.tile_height > 0 && job.tile_y < job.viewport_height && job.tile_height <= job.viewport_height - job.tile_y
+            && job.first_sample <= UINT32_MAX - job.number_of_samples;
+    }
+
+    bool Render_Worker::execute (const Render_Job & job)
+    {
+        if (not is_valid (job)) return false;
+
+        auto camera = space.get_scene ().get_camera ();
+
+        camera->transform.set_position (Vector3(job.camera.position[0], job.camera.position[1], job.camera.position[2]));
+        camera->transform.set_rotation (Vector3(job.camera.rotation[0], job.camera.rotation[1], job.camera.rotation[2]));
+        camera->transform.set_scales   (Vector3(job.camera.scales  [0], job.camera.scales  [1], job.camera.scales  [2]));
+        camera->set_focal_length       (job.camera.focal_length);
+
+        Path_Tracer::Tile tile{ job.tile_x, job.tile_y, job.tile_width, job.tile_height };
+
+        path_tracer.trace_tile
+        (
+            space,
+            job.viewport_width,
+            job.viewport_height,
+            tile,
+            job.first_sample,
+            job.number_of_samples,
+            tile_accumulation
+        );
+
+        Render_Result  result { job.frame, job.job, tile_accumulation.size () };
+        Render_Message message{ Render_Message::RESULT, uint32_t(sizeof(result) + result.pixel_count * sizeof(Accumulated_Color)) };
+
+        return connection.send_all (&message, sizeof(message))
+            && connection.send_all (&result,  sizeof(result ))
+            && connection.send_all (tile_accumulation.data (), result.pixel_count * sizeof(Accumulated_Color));
+    }
+
+}
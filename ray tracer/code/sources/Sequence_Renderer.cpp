@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <cstdio>
+#include <future>
+
+#include <raytracer/Image_File.hpp>
+#include <raytracer/Scene.hpp>
+#include <raytracer/Sequence_Renderer.hpp>
+#include <raytracer/Timer.hpp>
+
+namespace udit::raytracer
+{
+
+    // Las cámaras de la secuencia copian el sensor de la cámara principal de la escena
+
+    Sequence_Renderer::Sequence_Renderer(Spatial_Data_Structure & given_space, float given_frames_per_second)
+    :
+        space(given_space)
+    {
+        auto main_camera = space.get_scene ().get_camera ();
+
+        auto sensor_type  = main_camera ? main_camera->get_sensor_type  () : Camera::APS_C;
+        auto focal_length = main_camera ? main_camera->get_focal_length () : .035f;
+
+        for (auto & slot : slots)
+        {
+            slot.camera = std::make_unique< Pinhole_Camera > (sensor_type, focal_length);
+
+            slot.path_tracer.set_camera (slot.camera.get ());
+        }
+
+        frames_per_second = given_frames_per_second;
+    }
+
+    // Los fotogramas pares usan el primer trazador y los impares el segundo. Mientras uno traza el
+    // fotograma N, el otro prepara el N+1 en otro hilo y un tercero escribe la imagen del N-1, que
+    // sigue en el búfer del otro trazador hasta que este copie la suya.
+
+    Sequence_Renderer::Statistics Sequence_Renderer::render
+    (
+        const Camera_Path  & path,
+        unsigned             frame_count,
+        unsigned             viewport_width,
+        unsigned             viewport_height,
+        unsigned             samples_per_pixel,
+        const std::string  & output_prefix
+    )
+    {
+        Statistics statistics;
+
+        if (path.is_empty () or frame_count == 0 or viewport_width == 0 or viewport_height == 0) return statistics;
+
+        Timer timer;
+
+        std::future< bool > writing;
+
+        prepare (slots[0], path, 0, viewport_width, viewport_height);
+
+        for (unsigned frame = 0; frame < frame_count; ++frame)
+        {
+            Slot & current = slots[ frame      % 2];
+            Slot & next    = slots[(frame + 1) % 2];
+
+            std::future< void > preparing;
+
+            if (frame + 1 < frame_count)
+            {
+                preparing = std::async
+                (
+                    std::launch::async,
+                    [&, frame] () { prepare (next, path, frame + 1, viewport_width, viewport_height); }
+                );
+            }
+
+            current.path_tracer.trace (space, viewport_width, viewport_height, samples_per_pixel);
+
+            // La escritura del fotograma anterior (con el búfer del otro trazador) ha tenido todo
+            // este trazado para terminar. Se recoge antes de lanzar la de este.
+
+            if (writing.valid () and writing.get ()) ++statistics.frames;
+
+            current.path_tracer.copy_snapshot (current.image);
+
+            writing = std::async
+            (
+                std::launch::async,
+                [&current, path = get_frame_path (output_prefix, frame)] () { return Image_File::write_pfm (path, current.image); }
+            );
+
+            if (preparing.valid ()) preparing.get ();
+        }
+
+        if (writing.get ()) ++statistics.frames;
+
+        statistics.seconds         = timer.get_elapsed< Seconds > ();
+        statistics.frames_per_hour = statistics.seconds > 0.0 ? statistics.frames * 3600.0 / statistics.seconds : 0.0;
+
+        return statistics;
+    }
+
+    // Solo toca el trazador y la cámara de slot, por lo que puede ir a la vez que el otro traza
+
+    void Sequence_Renderer::prepare (Slot & slot, const Camera_Path & path, unsigned frame, unsigned viewport_width, unsigned viewport_height)
+    {
+        path.apply (*slot.camera, path.get_start_time () + float(frame) / frames_per_second);
+
+        // Cada fotograma empieza de cero aunque la cámara no se haya movido desde el anterior de
+        // este trazador
+
+        slot.path_tracer.discard_accumulation ();
+        slot.path_tracer.prepare (space, viewport_width, viewport_height);
+    }
+
+    std::string Sequence_Renderer::get_frame_path (const std::string & output_prefix, unsigned frame)
+    {
+        char number[16];
+
+        std::snprintf (number, sizeof(number), "%04u", frame);
+
+        return output_prefix + number + ".pfm";
+    }
+
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <raytracer/Socket.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    #include <cerrno>
+    #include <cstring>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+
+    #define SOCKETS_AVAILABLE 1
+
+#endif
+
+namespace udit::raytracer
+{
+
+    #if defined(SOCKETS_AVAILABLE)
+
+    namespace
+    {
+
+        bool split_tcp_address (const std::string & address, std::string & host, std::string & port)
+        {
+            auto separator = address.rfind (':');
+
+            if (separator == std::string::npos || separator < 4) return false;
+
+            host = address.substr (4, separator - 4);
+            port = address.substr (separator + 1);
+
+            return not port.empty ();
+        }
+
+        bool make_unix_address (const std::string & address, sockaddr_un & unix_address)
+        {
+            auto path = address.substr (5);
+
+            if (path.empty () || path.size () >= sizeof(unix_address.sun_path)) return false;
+
+            std::memset (&unix_address, 0, sizeof(unix_address));
+
+            unix_address.sun_family = AF_UNIX;
+
+            std::memcpy (unix_address.sun_path, path.c_str (), path.size () + 1);
+
+            return true;
+        }
+
+        // Sin el algoritmo de Nagle los mensajes pequeños (trabajos) salen sin esperar
+
+        void disable_delay (int handle)
+        {
+            int enabled = 1;
+
+            setsockopt (handle, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+        }
+
+    }
+
+    Socket Socket::listen (const std::string & address)
+    {
+        if (address.starts_with ("unix:"))
+        {
+            sockaddr_un unix_address;
+
+            if (not make_unix_address (address, unix_address)) return Socket();
+
+            Socket socket(::socket (AF_UNIX, SOCK_STREAM, 0));
+
+            ::unlink (unix_address.sun_path);
+
+            if (socket.is_open ()
+            &&  ::bind   (socket.handle, reinterpret_cast< sockaddr * >(&unix_address), sizeof(unix_address)) == 0
+            &&  ::listen (socket.handle, SOMAXCONN) == 0)
+            {
+                return socket;
+            }
+        }
+        else
+        if (address.starts_with ("tcp:"))
+        {
+            std::string host, port;
+
+            if (not split_tcp_address (address, host, port)) return Socket();
+
+            addrinfo   hints{ };
+            addrinfo * results = nullptr;
+
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags    = AI_PASSIVE;
+
+            if (getaddrinfo (host == "*" ? nullptr : host.c_str (), port.c_str (), &hints, &results) != 0) return Socket();
+
+            Socket socket;
+
+            for (auto result = results; result && not socket.is_open (); result = result->ai_next)
+            {
+                Socket candidate(::socket (result->ai_family, result->ai_socktype, result->ai_protocol));
+
+                int reuse = 1;
+
+                if (candidate.is_open ()
+                &&  setsockopt (candidate.handle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0
+                &&  ::bind   (candidate.handle, result->ai_addr, result->ai_addrlen) == 0
+                &&  ::listen (candidate.handle, SOMAXCONN) == 0)
+                {
+                    socket = std::move (candidate);
+                }
+            }
+
+            freeaddrinfo (results);
+
+            return socket;
+        }
+
+        return Socket();
+    }
+
+    Socket Socket::connect (const std::string & address)
+    {
+        if (address.starts_with ("unix:"))
+        {
+            sockaddr_un unix_address;
+
+            if (not make_unix_address (address, unix_address)) return Socket();
+
+            Socket socket(::socket (AF_UNIX, SOCK_STREAM, 0));
+
+            if (socket.is_open () && ::connect (socket.handle, reinterpret_cast< sockaddr * >(&unix_address), sizeof(unix_address)) == 0)
+            {
+                return socket;
+            }
+        }
+        else
+        if (address.starts_with ("tcp:"))
+        {
+            std::string host, port;
+
+            if (not split_tcp_address (address, host, port)) return Socket();
+
+            addrinfo   hints{ };
+            addrinfo * results = nullptr;
+
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            if (getaddrinfo (host.c_str (), port.c_str (), &hints, &results) != 0) return Socket();
+
+            Socket socket;
+
+            for (auto result = results; result && not socket.is_open (); result = result->ai_next)
+            {
+                Socket candidate(::socket (result->ai_family, result->ai_socktype, result->ai_protocol));
+
+                if (candidate.is_open () && ::connect (candidate.handle, result->ai_addr, result->ai_addrlen) == 0)
+                {
+                    disable_delay (candidate.handle);
+
+                    socket = std::move (candidate);
+                }
+            }
+
+            freeaddrinfo (results);
+
+            return socket;
+        }
+
+        return Socket();
+    }
+
+    Socket Socket::accept () const
+    {
+        Socket socket(::accept (handle, nullptr, nullptr));
+
+        if (socket.is_open ())
+        {
+            sockaddr_storage address;
+            socklen_t        length = sizeof(address);
+
+            if (getsockname (socket.handle, reinterpret_cast< sockaddr * >(&address), &length) == 0 && address.ss_family != AF_UNIX)
+            {
+                disable_delay (socket.handle);
+            }
+        }
+
+        return socket;
+    }
+
+    bool Socket::send_all (const void * data, size_t size)
+    {
+        auto bytes = static_cast< const char * >(data);
+
+        while (size > 0)
+        {
+            #if defined(MSG_NOSIGNAL)
+                auto sent = ::send (handle, bytes, size, MSG_NOSIGNAL);
+            #else
+                auto sent = ::send (handle, bytes, size, 0);
+            #endif
+
+            if (sent < 0 && errno == EINTR) continue;      // Interrumpido por una señal: se reintenta
+
+            if (sent <= 0) return false;
+
+            bytes += sent;
+            size  -= size_t(sent);
+        }
+
+        return true;
+    }
+
+    bool Socket::receive_all (void * data, size_t size)
+    {
+        auto bytes = static_cast< char * >(data);
+
+        while (size > 0)
+        {
+            auto received = ::recv (handle, bytes, size, 0);
+
+            if (received < 0 && errno == EINTR) continue;
+
+            if (received <= 0) return false;
+
+            bytes += received;
+            size  -= size_t(received);
+        }
+
+        return true;
+    }
+
+    void Socket::shutdown ()
+    {
+        if (is_open ()) ::shutdown (handle, SHUT_RDWR);
+    }
+
+    void Socket::close ()
+    {
+        if (is_open ()) ::close (std::exchange (handle, -1));
+    }
+
+    #else
+
+    Socket Socket::listen  (const std::string & ) { return Socket(); }
+    Socket Socket::connect (const std::string & ) { return Socket(); }
+    Socket Socket::accept  () const               { return Socket(); }
+
+    bool Socket::send_all    (const void * , size_t ) { return false; }
+    bool Socket::receive_all (void       * , size_t ) { return false; }
+
+    void Socket::shutdown () { }
+    void Socket::close    () { handle = -1; }
+
+    #endif
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <cassert>
+
+#include <raytracer/Intersection.hpp>
+#include <raytracer/Ray.hpp>
+#include <raytracer/Scene.hpp>
+#include <raytracer/Spatial_Data_Structure.hpp>
+
+namespace udit::raytracer
+{
+
+    // Se llama entre fotogramas, cuando ningún hilo está recorriendo la estructura, por lo que el
+    // intercambio de versiones es atómico respecto al render. Los contadores de generación de la
+    // escena indican qué hacer: si ha cambiado su composición se reconstruye en segundo plano y, si
+    // solo se han movido cosas, basta con reajustar los volúmenes. Devuelve true si la versión
+    // visible ha cambiado y, por tanto, lo acumulado hasta ahora ya no es válido.
+
+    bool Spatial_Data_Structure::update ()
+    {
+        auto generations = scene.get_generations ();
+
+        if (not ready)
+        {
+            classify_intersectables ();
+
+            built_geometry    = generations.geometry;
+            fitted_transforms = generations.transforms;
+
+            ++version;
+
+            return true;
+        }
+
+        bool changed = false;
+
+        if (not rebuilding && generations.geometry != built_geometry)
+        {
+            built_geometry      = generations.geometry;
+            launched_transforms = generations.transforms;
+            rebuilding          = true;
+
+            start_rebuild ();
+        }
+
+        if (rebuilding && finish_rebuild ())
+        {
+            rebuilding        = false;
+            fitted_transforms = launched_transforms;
+            changed           = true;
+        }
+
+        if (generations.transforms != fitted_transforms)
+        {
+            refit ();
+
+            fitted_transforms = generations.transforms;
+            changed           = true;
+        }
+
+        if (changed) ++version;
+
+        return changed;
+    }
+
+    Intersectable * Spatial_Data_Structure::occluded (const Ray & ray, float min_t, float max_t) const
+    {
+        Intersection intersection;
+
+        return traverse (ray, min_t, max_t, intersection) ? intersection.intersectable : nullptr;
+    }
+
+    void Spatial_Data_Structure::traverse
+    (
+        std::span< const Ray > rays,
+        std::span< Intersection > intersections,
+        unsigned flags,
+        float    min_t,
+        float    max_t
+    ) const
+    {
+        assert(rays.size () == intersections.size ());
+
+        for (size_t index = 0; index < rays.size (); ++index)
+        {
+            if (flags & ANY_HIT)
+            {
+                intersections[index].intersectable = occluded (rays[index], min_t, max_t);
+            }
+            else
+            if (not traverse (rays[index], min_t, max_t, intersections[index]))
+            {
+                intersections[index].intersectable = nullptr;
+            }
+        }
+    }
+
+}
@@ -11,29 +11,59 @@
 namespace udit::raytracer
 {
 
-    float Sphere::intersect (const Ray & ray, float min_t, float max_t) const
+    namespace
     {
-        Vector3 center_origin = ray.origin - center;
 
-        float a = dot (ray.direction, ray.direction);
-        float b = dot (center_origin, ray.direction);
-        float c = dot (center_origin, center_origin) - radius * radius;
-        float d = b * b - a * c;
+        // Compartido por las dos versiones de Sphere::intersect() para que el bucle del lote no
+        // tenga que llamar a una función por rayo.
 
-        if (d > 0.f)
+        inline float intersect_sphere (const Vector3 & center, float radius, const Ray & ray, float min_t, float max_t)
         {
-            d = sqrt (d);
+            Vector3 center_origin = ray.origin - center;
+
+            float a = dot (ray.direction, ray.direction);
+            float b = dot (center_origin, ray.direction);
+            float c = dot (center_origin, center_origin) - radius * radius;
+            float d = b * b - a * c;
+
+            if (d > 0.f)
+            {
+                d = sqrt (d);
+
+                float t1 = (-b - d) / a;
 
-            float t1 = (-b - d) / a;
+                if (t1 > min_t && t1 < max_t) return t1;
 
-            if (t1 > min_t && t1 < max_t) return t1;
+                float t2 = (-b + d) / a;
 
-            float t2 = (-b + d) / a;
+                if (t2 > min_t && t2 < max_t) return t2;
+            }
 
-            if (t2 > min_t && t2 < max_t) return t2;
+            return -1.f;
         }
 
-        return -1.f;
+    }
+
+    float Sphere::intersect (const Ray & ray, float min_t, float max_t) const
+    {
+        return intersect_sphere (center, radius, ray, min_t, max_t);
+    }
+
+    void Sphere::intersect (std::span< const Ray > rays, float min_t, std::span< Intersection > intersections) const
+    {
+        const Vector3 center = this->center;
+        const float   radius = this->radius;
+
+        for (size_t index = 0, count = rays.size (); index < count; ++index)
+        {
+            float t = intersect_sphere (center, radius, rays[index], min_t, intersections[index].t);
+
+            if (t > 0.f)
+            {
+                intersections[index].t = t;
+                intersections[index].intersectable = const_cast< Sphere * >(this);
+            }
+        }
     }
 
 }
@@ -0,0 +1,369 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <raytracer/Texture.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #define MEMORY_MAPPING_AVAILABLE
+
+#endif
+
+namespace udit::raytracer
+{
+
+    namespace
+    {
+
+        constexpr char magic[8] = { 'U', 'R', 'T', 'T', 'E', 'X', 'T', 'R' };
+
+        float srgb_to_linear (float value)
+        {
+            return value <= .04045f ? value / 12.92f : std::pow ((value + .055f) / 1.055f, 2.4f);
+        }
+
+        uint8_t linear_to_srgb (float value)
+        {
+            value = std::clamp (value, 0.f, 1.f);
+            value = value <= .0031308f ? value * 12.92f : 1.055f * std::pow (value, 1.f / 2.4f) - .055f;
+
+            return uint8_t(value * 255.f + .5f);
+        }
+
+        const std::array< float, 256 > & get_decoding_table ()
+        {
+            static const std::array< float, 256 > table = []
+            {
+                std::array< float, 256 > values;
+
+                for (unsigned index = 0; index < 256; ++index)
+                {
+                    values[index] = srgb_to_linear (float(index) / 255.f);
+                }
+
+                return values;
+            }();
+
+            return table;
+        }
+
+        unsigned wrap (int coordinate, unsigned size)
+        {
+            coordinate %= int(size);
+
+            return unsigned(coordinate < 0 ? coordinate + int(size) : coordinate);
+        }
+
+        unsigned tiles_for (unsigned size)
+        {
+            return (size + Texture::tile_size - 1) / Texture::tile_size;
+        }
+
+        // Últimas baldosas que ha usado cada hilo. Casi todas las consultas seguidas de un hilo
+        // caen en las mismas baldosas, y así no tienen que bloquear la caché compartida ni copiar
+        // su shared_ptr. Se reemplazan por turno, de modo que una baldosa recién pedida sigue aquí
+        // al menos durante las siguientes recent_tile_count - 1 peticiones.
+
+        constexpr unsigned recent_tile_count = 8;
+
+        struct Recent_Tiles
+        {
+            std::array< uint64_t,                recent_tile_count > keys;
+            std::array< Texture_Cache::Tile_Ptr, recent_tile_count > tiles;
+            unsigned                                                 next = 0;
+        };
+
+        thread_local Recent_Tiles recent_tiles;
+
+    }
+
+    Texture::Texture(Texture_Cache & given_cache, const std::string & path)
+    :
+        cache       (given_cache),
+        id          (given_cache.register_texture ()),
+        file        (-1),
+        mapping     (nullptr),
+        mapping_size(0),
+        level_count (0)
+    {
+        #if defined(MEMORY_MAPPING_AVAILABLE)
+
+            file = ::open (path.c_str (), O_RDONLY);
+
+            if (file < 0) return;
+
+            Header      header;
+            struct stat status;
+
+            if (fstat (file, &status) != 0
+            or  ::pread (file, &header, sizeof(header), 0) != ssize_t(sizeof(header))
+            or  std::memcmp (header.magic, magic, sizeof(magic)) != 0
+            or  header.version != version
+            or  header.levels  == 0
+            or  header.levels  >  max_levels)
+            {
+                return;
+            }
+
+            for (unsigned level = 0; level < header.levels; ++level)
+            {
+                unsigned width  = std::max (header.width  >> level, 1u);
+                unsigned height = std::max (header.height >> level, 1u);
+
+                levels[level] = Level{ width, height, tiles_for (width), header.level_offsets[level] };
+
+                // El fichero tiene que llegar hasta la última baldosa de cada nivel
+
+                if (header.level_offsets[level] + uint64_t(tiles_for (width)) * tiles_for (height) * tile_bytes > uint64_t(status.st_size)) return;
+            }
+
+            void * address = ::mmap (nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+
+            if (address == MAP_FAILED) return;
+
+            mapping      = static_cast< const uint8_t * >(address);
+            mapping_size = size_t(status.st_size);
+            level_count  = header.levels;
+
+        #else
+
+            (void)path;
+
+        #endif
+    }
+
+    Texture::~Texture()
+    {
+        #if defined(MEMORY_MAPPING_AVAILABLE)
+
+            if (mapping) ::munmap (const_cast< uint8_t * >(mapping), mapping_size);
+            if (file >= 0) ::close (file);
+
+        #endif
+    }
+
+    Color Texture::sample (const Vector2 & uv, float footprint) const
+    {
+        if (not is_loaded ()) return Color(1, 1, 1);
+
+        // Nivel en el que un texel mide lo mismo que la huella
+
+        float size  = float(std::max (levels[0].width, levels[0].height));
+        float lod   = std::min (std::log2 (std::max (footprint * size, 1.f)), float(level_count - 1));
+        auto  level = unsigned(lod);
+        float blend = lod - float(level);
+
+        Color color = sample_level (level, uv);
+
+        if (blend > 0.f and level + 1 < level_count)
+        {
+            color = mix (color, sample_level (level + 1, uv), blend);
+        }
+
+        return color;
+    }
+
+    // Filtrado bilineal dentro de un nivel. Casi siempre los cuatro texels están en la misma
+    // baldosa y solo se pide una a la caché.
+
+    Color Texture::sample_level (unsigned level, const Vector2 & uv) const
+    {
+        auto & data = levels[level];
+
+        float x = (uv.x - std::floor (uv.x)) * float(data.width ) - .5f;
+        float y = (uv.y - std::floor (uv.y)) * float(data.height) - .5f;
+
+        float x0 = std::floor (x);
+        float y0 = std::floor (y);
+        float fx = x - x0;
+        float fy = y - y0;
+
+        const Texture_Cache::Tile * tile   = nullptr;
+        unsigned                    tile_x = ~0u;
+        unsigned                    tile_y = ~0u;
+
+        auto texel = [&](int column, int row)
+        {
+            unsigned tx = wrap (column, data.width );
+            unsigned ty = wrap (row,    data.height);
+
+            if (tx / tile_size != tile_x or ty / tile_size != tile_y)
+            {
+                tile_x = tx / tile_size;
+                tile_y = ty / tile_size;
+                tile   = &get_tile (level, tile_x, tile_y);
+            }
+
+            return (*tile)[(ty % tile_size) * tile_size + tx % tile_size];
+        };
+
+        int column = int(x0);
+        int row    = int(y0);
+
+        return mix
+        (
+            mix (texel (column, row    ), texel (column + 1, row    ), fx),
+            mix (texel (column, row + 1), texel (column + 1, row + 1), fx),
+            fy
+        );
+    }
+
+    // La referencia vale hasta que el hilo pide recent_tile_count baldosas más, lo que basta para
+    // las (como mucho) cuatro de un filtrado bilineal
+
+    const Texture_Cache::Tile & Texture::get_tile (unsigned level, unsigned tile_x, unsigned tile_y) const
+    {
+        uint64_t key = uint64_t(id) << 40 | uint64_t(level) << 32 | (tile_y * levels[level].tiles_x + tile_x);
+
+        auto & recent = recent_tiles;
+
+        for (unsigned index = 0; index < recent_tile_count; ++index)
+        {
+            if (recent.keys[index] == key and recent.tiles[index]) return *recent.tiles[index];
+        }
+
+        auto & slot = recent.tiles[recent.next];
+
+        slot = cache.get (key, [&](Texture_Cache::Tile & tile) { load_tile (level, tile_x, tile_y, tile); });
+
+        recent.keys[recent.next] = key;
+        recent.next = (recent.next + 1) % recent_tile_count;
+
+        return *slot;
+    }
+
+    void Texture::load_tile (unsigned level, unsigned tile_x, unsigned tile_y, Texture_Cache::Tile & tile) const
+    {
+        auto & table = get_decoding_table ();
+        auto   bytes = mapping + levels[level].offset + uint64_t(tile_y * levels[level].tiles_x + tile_x) * tile_bytes;
+
+        for (unsigned index = 0; index < tile_size * tile_size; ++index)
+        {
+            tile[index] = Color(table[bytes[index * 4 + 0]], table[bytes[index * 4 + 1]], table[bytes[index * 4 + 2]]);
+        }
+
+        // Ya decodificada, la página del fichero deja de ocupar memoria
+
+        #if defined(MEMORY_MAPPING_AVAILABLE)
+            ::madvise (const_cast< uint8_t * >(bytes), tile_bytes, MADV_DONTNEED);
+        #endif
+    }
+
+    bool Texture::convert (const std::string & path, unsigned width, unsigned height, std::span< const Color > texels)
+    {
+        if (width == 0 or height == 0 or texels.size () < size_t(width) * height) return false;
+
+        // Cada nivel es la media de bloques de 2x2 del anterior
+
+        std::vector< std::vector< Color > > images{ std::vector< Color >(texels.begin (), texels.begin () + size_t(width) * height) };
+
+        Header header{};
+
+        std::memcpy (header.magic, magic, sizeof(magic));
+
+        header.version = version;
+        header.width   = width;
+        header.height  = height;
+
+        while (images.size () < max_levels and (width >> (images.size () - 1) > 1 or height >> (images.size () - 1) > 1))
+        {
+            auto   level         = unsigned(images.size ());
+            auto & source        = images.back ();
+            auto   source_width  = std::max (width  >> (level - 1), 1u);
+            auto   source_height = std::max (height >> (level - 1), 1u);
+            auto   target_width  = std::max (width  >> level, 1u);
+            auto   target_height = std::max (height >> level, 1u);
+
+            std::vector< Color > target(size_t(target_width) * target_height);
+
+            for (unsigned y = 0; y < target_height; ++y)
+            {
+                for (unsigned x = 0; x < target_width; ++x)
+                {
+                    unsigned x0 = std::min (x * 2, source_width  - 1), x1 = std::min (x * 2 + 1, source_width  - 1);
+                    unsigned y0 = std::min (y * 2, source_height - 1), y1 = std::min (y * 2 + 1, source_height - 1);
+
+                    target[y * target_width + x] = (source[y0 * source_width + x0] + source[y0 * source_width + x1]
+                                                 +  source[y1 * source_width + x0] + source[y1 * source_width + x1]) * .25f;
+                }
+            }
+
+            images.push_back (std::move (target));
+        }
+
+        header.levels = unsigned(images.size ());
+
+        uint64_t offset = data_offset;
+
+        for (unsigned level = 0; level < header.levels; ++level)
+        {
+            header.level_offsets[level] = offset;
+
+            offset += uint64_t(tiles_for (std::max (width >> level, 1u))) * tiles_for (std::max (height >> level, 1u)) * tile_bytes;
+        }
+
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+
+        if (not output) return false;
+
+        std::vector< char > page(data_offset, 0);
+
+        std::memcpy (page.data (), &header, sizeof(header));
+
+        output.write (page.data (), std::streamsize(page.size ()));
+
+        // Las baldosas de los bordes se completan repitiendo el último texel
+
+        std::vector< uint8_t > tile(tile_bytes);
+
+        for (unsigned level = 0; level < header.levels; ++level)
+        {
+            auto & image        = images[level];
+            auto   level_width  = std::max (width  >> level, 1u);
+            auto   level_height = std::max (height >> level, 1u);
+
+            for (unsigned tile_y = 0; tile_y < tiles_for (level_height); ++tile_y)
+            {
+                for (unsigned tile_x = 0; tile_x < tiles_for (level_width); ++tile_x)
+                {
+                    for (unsigned y = 0; y < tile_size; ++y)
+                    {
+                        for (unsigned x = 0; x < tile_size; ++x)
+                        {
+                            unsigned source_x = std::min (tile_x * tile_size + x, level_width  - 1);
+                            unsigned source_y = std::min (tile_y * tile_size + y, level_height - 1);
+                            auto   & color    = image[source_y * level_width + source_x];
+                            auto     texel    = (y * tile_size + x) * 4;
+
+                            tile[texel + 0] = linear_to_srgb (color.r);
+                            tile[texel + 1] = linear_to_srgb (color.g);
+                            tile[texel + 2] = linear_to_srgb (color.b);
+                            tile[texel + 3] = 255;
+                        }
+                    }
+
+                    output.write (reinterpret_cast< const char * >(tile.data ()), std::streamsize(tile.size ()));
+                }
+            }
+        }
+
+        return bool(output);
+    }
+
+}
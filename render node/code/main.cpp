@@ -0,0 +1,356 @@
+/*
+ * Copyright © 2025+ ÁRgB (angel.rodriguez@udit.es)
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See ./LICENSE or www.boost.org/LICENSE_1_0.txt
+ */
+
+// Proceso que aloja el trazado por encargo y el trazado repartido de la biblioteca sin la ventana
+// de la aplicación:
+//
+//     render-node server      <dirección>
+//     render-node submit      <dirección> <salida.pfm> <ancho> <alto> <muestras> [prioridad]
+//     render-node query       <dirección> <trabajo>
+//     render-node stop        <dirección>
+//     render-node coordinator <dirección> <trabajadores> <salida.pfm> <ancho> <alto> <muestras>
+//     render-node worker      <dirección>
+//     render-node check       <trabajadores>
+//
+// La dirección es "unix:<ruta>" o "tcp:<host>:<puerto>". Todos los procesos construyen la misma
+// escena de ejemplo (la de la aplicación), por lo que los trabajos solo indican la vista. Con
+// check se reparte una imagen entre trabajadores locales y se compara con la trazada en un solo
+// proceso (es la prueba que ejecuta ctest).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <raytracer/Diffuse_Material.hpp>
+#include <raytracer/Image_File.hpp>
+#include <raytracer/Linear_Space.hpp>
+#include <raytracer/Metallic_Material.hpp>
+#include <raytracer/Model.hpp>
+#include <raytracer/Pinhole_Camera.hpp>
+#include <raytracer/Path_Tracer.hpp>
+#include <raytracer/Plane.hpp>
+#include <raytracer/Render_Coordinator.hpp>
+#include <raytracer/Render_Protocol.hpp>
+#include <raytracer/Render_Server.hpp>
+#include <raytracer/Render_Worker.hpp>
+#include <raytracer/Scene.hpp>
+#include <raytracer/Skydome.hpp>
+#include <raytracer/Socket.hpp>
+#include <raytracer/Sphere.hpp>
+
+using namespace std;
+using namespace udit::raytracer;
+
+namespace
+{
+
+    void load_scene (Scene & scene)
+    {
+        scene.create< Skydome > (Color{.5f, .75f, 1.f}, Color{1, 1, 1});
+        scene.create< Pinhole_Camera > (Camera::APS_C, 16.f / 1000.f);
+
+        auto ground = scene.create< Model > ();
+
+        ground->add (scene.create< Plane > (Vector3{0, .25f, 0}, Vector3{0, -1, 0}, scene.create< Diffuse_Material > (Color(.4f, .4f, .5f))));
+
+        auto shape = scene.create< Model > ();
+
+        shape->add (scene.create< Sphere > (Vector3{.0f, 0.f, -1.0f}, .25f, scene.create< Diffuse_Material  > (Color(.8f, .8f, .8f))));
+        shape->add (scene.create< Sphere > (Vector3{.5f, 0.f, -1.1f}, .15f, scene.create< Metallic_Material > (Color(.4f, .5f, .6f), 0.1f)));
+    }
+
+    bool parse (const char * text, uint32_t & value)
+    {
+        char * end;
+
+        unsigned long parsed = std::strtoul (text, &end, 10);
+
+        if (end == text || *end != '\0' || parsed > UINT32_MAX) return false;
+
+        value = uint32_t(parsed);
+
+        return true;
+    }
+
+    // Cámara en el origen mirando hacia -z, como la de la aplicación al empezar
+
+    Render_Camera_State default_camera ()
+    {
+        return { { 0, 0, 0 }, { 0, 0, 0 }, { 1, 1, 1 }, 16.f / 1000.f };
+    }
+
+    int run_server (const string & address)
+    {
+        Scene         scene;
+        Linear_Space  space(scene);
+        Render_Server server(space);
+
+        load_scene (scene);
+
+        if (not server.listen (address))
+        {
+            cerr << "cannot listen on " << address << endl;
+            return 1;
+        }
+
+        cout << server.run () << " jobs completed" << endl;
+
+        return 0;
+    }
+
+    // Envía un mensaje al servidor y, salvo con STOP, muestra el estado que responde
+
+    int send_request (const string & address, Render_Message::Type type, const void * body, uint32_t size)
+    {
+        Socket connection = Socket::connect (address);
+
+        if (not connection.is_open ())
+        {
+            cerr << "cannot connect to " << address << endl;
+            return 1;
+        }
+
+        Render_Message message{ type, size };
+
+        if (not connection.send_all (&message, sizeof(message)) || not connection.send_all (body, size)) return 1;
+
+        if (type == Render_Message::STOP) return 0;
+
+        Render_Message    reply;
+        Render_Job_Status status;
+
+        if (not connection.receive_all (&reply,  sizeof(reply ))
+        ||  reply.type != Render_Message::STATUS
+        ||  not connection.receive_all (&status, sizeof(status))) return 1;
+
+        static const char * state_names[] = { "unknown", "queued", "running", "completed", "failed" };
+
+        cout << "job " << status.id << ": " << (status.state < 5 ? state_names[status.state] : "?")
+             << " (" << status.queued_jobs << " queued)" << endl;
+
+        return status.state == Render_Job_Status::FAILED ? 1 : 0;
+    }
+
+    int submit (const string & address, int argc, char * argv[])
+    {
+        Render_Server_Job job{ };
+
+        job.camera = default_camera ();
+
+        if (not parse (argv[1], job.viewport_width   )
+        ||  not parse (argv[2], job.viewport_height  )
+        ||  not parse (argv[3], job.samples_per_pixel)
+        ||  (argc > 4 && not parse (argv[4], job.priority))
+        ||  std::strlen (argv[0]) >= sizeof(job.output_path)) return -1;
+
+        std::strcpy (job.output_path, argv[0]);
+
+        return send_request (address, Render_Message::SUBMIT, &job, sizeof(job));
+    }
+
+    int run_worker (const string & address)
+    {
+        Scene         scene;
+        Linear_Space  space(scene);
+        Render_Worker worker(space);
+
+        load_scene (scene);
+
+        if (not worker.connect (address))
+        {
+            cerr << "cannot connect to " << address << endl;
+            return 1;
+        }
+
+        cout << worker.run () << " jobs completed" << endl;
+
+        return 0;
+    }
+
+    int run_coordinator (const string & address, char * argv[])
+    {
+        uint32_t worker_count, width, height, samples;
+
+        if (not parse (argv[0], worker_count) || not parse (argv[2], width) || not parse (argv[3], height) || not parse (argv[4], samples)) return -1;
+
+        Scene                       scene;
+        Render_Coordinator          coordinator;
+        Buffer< Accumulated_Color > accumulation;
+        Buffer< Color >             image;
+
+        load_scene (scene);
+
+        if (not coordinator.listen (address))
+        {
+            cerr << "cannot listen on " << address << endl;
+            return 1;
+        }
+
+        cout << coordinator.accept_workers (worker_count) << " workers connected" << endl;
+
+        if (not coordinator.render (*scene.get_camera (), width, height, 0, samples, accumulation))
+        {
+            cerr << "the frame could not be rendered" << endl;
+            return 1;
+        }
+
+        image.resize_as (accumulation);
+
+        for (unsigned offset = 0, size = accumulation.size (); offset < size; ++offset)
+        {
+            image.set (offset, accumulation.get (offset).get_average ());
+        }
+
+        return Image_File::write_pfm (argv[1], image) ? 0 : 1;
+    }
+
+    // Los trabajadores son copias de este proceso (fork), que ya tienen la escena. Se crean antes
+    // de que el coordinador lance ningún hilo. Los dos resultados solo difieren en el orden en que
+    // se suman las muestras de cada píxel.
+
+    int run_check (uint32_t worker_count)
+    {
+        constexpr unsigned width   = 96;
+        constexpr unsigned height  = 64;
+        constexpr unsigned samples = 8;
+
+        Scene                       scene;
+        Linear_Space                space(scene);
+        Buffer< Accumulated_Color > distributed;
+        Buffer< Accumulated_Color > local;
+
+        load_scene (scene);
+
+        string path    = "/tmp/render-node-" + to_string (getpid ()) + ".sock";
+        string address = "unix:" + path;
+        bool   rendered;
+
+        {
+            Render_Coordinator coordinator(32, 2);
+
+            if (not coordinator.listen (address))
+            {
+                cerr << "cannot listen on " << address << endl;
+                return 1;
+            }
+
+            for (uint32_t index = 0; index < worker_count; ++index)
+            {
+                if (fork () == 0)
+                {
+                    Render_Worker worker(space);
+
+                    _exit (worker.connect (address) ? (worker.run (), 0) : 1);
+                }
+            }
+
+            rendered = coordinator.accept_workers (worker_count) == worker_count
+                    && coordinator.render (*scene.get_camera (), width, height, 0, samples, distributed);
+        }
+
+        while (wait (nullptr) > 0) { }
+
+        unlink (path.c_str ());
+
+        if (not rendered)
+        {
+            cerr << "the frame could not be rendered" << endl;
+            return 1;
+        }
+
+        Path_Tracer path_tracer;
+
+        path_tracer.trace_tile (space, width, height, Path_Tracer::Tile{ 0, 0, width, height }, 0, samples, local);
+
+        float maximum_error = 0.f;
+
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                Color a = distributed.get (x, y).get_average ();
+                Color b = local      .get (x, y).get_average ();
+
+                maximum_error = std::max ({ maximum_error, std::abs (a.r - b.r), std::abs (a.g - b.g), std::abs (a.b - b.b) });
+            }
+        }
+
+        cout << worker_count << " workers, maximum difference " << maximum_error << endl;
+
+        return maximum_error <= 1e-4f ? 0 : 1;
+    }
+
+    int usage ()
+    {
+        cerr << "usage: render-node server      <address>\n"
+                "       render-node submit      <address> <output.pfm> <width> <height> <samples> [priority]\n"
+                "       render-node query       <address> <job>\n"
+                "       render-node stop        <address>\n"
+                "       render-node coordinator <address> <workers> <output.pfm> <width> <height> <samples>\n"
+                "       render-node worker      <address>\n"
+                "       render-node check       <workers>\n";
+        return 2;
+    }
+
+}
+
+int main (int argc, char * argv[])
+{
+    if (argc < 3) return usage ();
+
+    string mode    = argv[1];
+    string address = argv[2];
+    int    result  = -1;
+
+    if (mode == "server")
+    {
+        result = run_server (address);
+    }
+    else
+    if (mode == "submit" && argc >= 7)
+    {
+        result = submit (address, argc - 3, argv + 3);
+    }
+    else
+    if (mode == "query" && argc == 4)
+    {
+        uint32_t id;
+
+        if (parse (argv[3], id)) result = send_request (address, Render_Message::QUERY, &id, sizeof(id));
+    }
+    else
+    if (mode == "stop")
+    {
+        result = send_request (address, Render_Message::STOP, nullptr, 0);
+    }
+    else
+    if (mode == "coordinator" && argc == 8)
+    {
+        result = run_coordinator (address, argv + 3);
+    }
+    else
+    if (mode == "worker")
+    {
+        result = run_worker (address);
+    }
+    else
+    if (mode == "check")
+    {
+        uint32_t worker_count;
+
+        if (parse (argv[2], worker_count) && worker_count > 0) result = run_check (worker_count);
+    }
+
+    return result < 0 ? usage () : result;
+}